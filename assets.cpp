@@ -0,0 +1,253 @@
+#include "assets.h"
+#include "pack.h"
+#include "log.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+enum AssetKind {
+    ASSET_TEXTURE,
+    ASSET_CHUNK
+};
+
+struct AssetJob {
+    AssetKind kind;
+    std::string path;
+    std::function<void(SDL_Texture*)> onTexture;
+    std::function<void(Mix_Chunk*)> onChunk;
+
+    // Filled in by the worker.
+    SDL_Surface* surface = nullptr;
+    Mix_Chunk* chunk = nullptr;
+    std::string error;
+};
+
+// Never more workers than this; decoding a few dozen files does not scale further.
+static const int MAX_ASSET_WORKERS = 4;
+
+static std::vector<SDL_Thread*> workers;
+static SDL_mutex* queueMutex = nullptr;
+static SDL_cond* jobReady = nullptr;
+static SDL_cond* resultReady = nullptr;
+static std::deque<AssetJob*> jobs;
+static std::deque<AssetJob*> results;
+static int inFlight = 0;
+static bool stopping = false;
+
+// Takes the asset from the mapped pack if it is there, so nothing needs
+// decoding. Returns false to fall back to the loose file.
+static bool loadFromPack(AssetJob* job)
+{
+    const PackEntry* entry = findPackEntry(assetId(job->path.c_str()));
+    if (!entry)
+        return false;
+    switch (job->kind) {
+        case ASSET_TEXTURE:
+            job->surface = packSurface(entry);
+            return job->surface != nullptr;
+        case ASSET_CHUNK:
+            // Compressed music is packed as the original file.
+            job->chunk = entry->kind == PACK_RAW ? Mix_LoadWAV_RW(packRW(entry), 1) : packChunk(entry);
+            return job->chunk != nullptr;
+    }
+    return false;
+}
+
+static void decodeJob(AssetJob* job)
+{
+    if (loadFromPack(job))
+        return;
+    switch (job->kind) {
+        case ASSET_TEXTURE:
+            job->surface = IMG_Load(job->path.c_str());
+            if (!job->surface)
+                job->error = IMG_GetError();
+            break;
+        case ASSET_CHUNK:
+            job->chunk = Mix_LoadWAV(job->path.c_str());
+            if (!job->chunk)
+                job->error = Mix_GetError();
+            break;
+    }
+}
+
+static int assetWorker(void*)
+{
+    for (;;) {
+        SDL_LockMutex(queueMutex);
+        while (jobs.empty() && !stopping) {
+            SDL_CondWait(jobReady, queueMutex);
+        }
+        if (jobs.empty()) {
+            SDL_UnlockMutex(queueMutex);
+            return 0;
+        }
+        AssetJob* job = jobs.front();
+        jobs.pop_front();
+        SDL_UnlockMutex(queueMutex);
+
+        decodeJob(job);
+
+        SDL_LockMutex(queueMutex);
+        results.push_back(job);
+        SDL_CondSignal(resultReady);
+        SDL_UnlockMutex(queueMutex);
+    }
+}
+
+void startAssetLoader()
+{
+    if (queueMutex)
+        return;
+    queueMutex = SDL_CreateMutex();
+    jobReady = SDL_CreateCond();
+    resultReady = SDL_CreateCond();
+    stopping = false;
+
+    // Leave one core for the render thread.
+    int count = SDL_GetCPUCount() - 1;
+    if (count < 1) count = 1;
+    if (count > MAX_ASSET_WORKERS) count = MAX_ASSET_WORKERS;
+    for (int i = 0; i < count; i++) {
+        SDL_Thread* thread = SDL_CreateThread(assetWorker, "AssetWorker", nullptr);
+        if (thread) {
+            workers.push_back(thread);
+        } else {
+            LOG_ERROR(LOG_ASSETS, "Failed to start asset worker: %s", SDL_GetError());
+        }
+    }
+}
+
+static void freeJob(AssetJob* job)
+{
+    if (job->surface) SDL_FreeSurface(job->surface);
+    if (job->chunk)   Mix_FreeChunk(job->chunk);
+    delete job;
+}
+
+void stopAssetLoader()
+{
+    if (!queueMutex)
+        return;
+    SDL_LockMutex(queueMutex);
+    stopping = true;
+    for (AssetJob* job : jobs) {
+        delete job;
+    }
+    inFlight -= (int)jobs.size();
+    jobs.clear();
+    SDL_CondBroadcast(jobReady);
+    SDL_UnlockMutex(queueMutex);
+
+    for (SDL_Thread* thread : workers) {
+        SDL_WaitThread(thread, nullptr);
+    }
+    workers.clear();
+
+    for (AssetJob* job : results) {
+        freeJob(job);
+    }
+    results.clear();
+    inFlight = 0;
+
+    SDL_DestroyCond(resultReady);
+    SDL_DestroyCond(jobReady);
+    SDL_DestroyMutex(queueMutex);
+    resultReady = nullptr;
+    jobReady = nullptr;
+    queueMutex = nullptr;
+}
+
+static void submitJob(AssetJob* job)
+{
+    if (!queueMutex || workers.empty()) {
+        // No pool; decode inline so callers still get their callback on pump.
+        decodeJob(job);
+        results.push_back(job);
+        inFlight++;
+        return;
+    }
+    SDL_LockMutex(queueMutex);
+    jobs.push_back(job);
+    inFlight++;
+    SDL_CondSignal(jobReady);
+    SDL_UnlockMutex(queueMutex);
+}
+
+void requestTexture(const std::string& path, std::function<void(SDL_Texture*)> onReady)
+{
+    AssetJob* job = new AssetJob();
+    job->kind = ASSET_TEXTURE;
+    job->path = path;
+    job->onTexture = onReady;
+    submitJob(job);
+}
+
+void requestChunk(const std::string& path, std::function<void(Mix_Chunk*)> onReady)
+{
+    AssetJob* job = new AssetJob();
+    job->kind = ASSET_CHUNK;
+    job->path = path;
+    job->onChunk = onReady;
+    submitJob(job);
+}
+
+static void deliverJob(SDL_Renderer* renderer, AssetJob* job)
+{
+    if (!job->error.empty())
+        LOG_ERROR(LOG_ASSETS, "Failed to load %s: %s", job->path.c_str(), job->error.c_str());
+
+    switch (job->kind) {
+        case ASSET_TEXTURE: {
+            SDL_Texture* texture = nullptr;
+            if (job->surface) {
+                texture = SDL_CreateTextureFromSurface(renderer, job->surface);
+                if (!texture)
+                    LOG_ERROR(LOG_ASSETS, "Failed to create texture for %s: %s", job->path.c_str(), SDL_GetError());
+                SDL_FreeSurface(job->surface);
+                job->surface = nullptr;
+            }
+            if (job->onTexture) job->onTexture(texture);
+            else if (texture) SDL_DestroyTexture(texture);
+            break;
+        }
+        case ASSET_CHUNK:
+            if (job->onChunk) { job->onChunk(job->chunk); job->chunk = nullptr; }
+            break;
+    }
+    freeJob(job);
+}
+
+int pumpAssetLoader(SDL_Renderer* renderer, Uint32 waitMs)
+{
+    std::deque<AssetJob*> ready;
+    if (queueMutex) {
+        SDL_LockMutex(queueMutex);
+        if (results.empty() && waitMs > 0 && inFlight > 0)
+            SDL_CondWaitTimeout(resultReady, queueMutex, waitMs);
+        ready.swap(results);
+        inFlight -= (int)ready.size();
+        SDL_UnlockMutex(queueMutex);
+    } else {
+        ready.swap(results);
+        inFlight -= (int)ready.size();
+    }
+
+    for (AssetJob* job : ready) {
+        deliverJob(renderer, job);
+    }
+    return (int)ready.size();
+}
+
+bool assetsPending()
+{
+    if (!queueMutex)
+        return inFlight > 0;
+    SDL_LockMutex(queueMutex);
+    bool pending = inFlight > 0;
+    SDL_UnlockMutex(queueMutex);
+    return pending;
+}
@@ -0,0 +1,33 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <functional>
+#include <string>
+
+// Background asset loader. Image and audio files (music included, which
+// SDL_mixer decodes to PCM like any sound effect) are decoded on a pool of
+// worker threads; textures are created and callbacks run on the thread that
+// calls pumpAssetLoader(), which must be the render thread.
+
+// Starts the worker threads. Call after IMG_Init and Mix_OpenAudio.
+void startAssetLoader();
+
+// Joins the workers and frees anything decoded but never delivered.
+void stopAssetLoader();
+
+// Queues a decode. Requests are served in the order they are made, so the
+// assets needed for the first frame should be requested first. A failed
+// load calls back with nullptr after logging the error.
+void requestTexture(const std::string& path, std::function<void(SDL_Texture*)> onReady);
+void requestChunk(const std::string& path, std::function<void(Mix_Chunk*)> onReady);
+
+// Uploads finished decodes and runs their callbacks. Waits up to waitMs for
+// the first result if none is ready. Returns the number of assets delivered.
+int pumpAssetLoader(SDL_Renderer* renderer, Uint32 waitMs = 0);
+
+// True while requests are queued, decoding, or waiting to be pumped.
+bool assetsPending();
+
+#endif // ASSETS_H
@@ -1,122 +1,372 @@
 #include "globals.h"
 #include "audio.h"
 #include "boosters.h"
-#include <iostream>
+#include "assets.h"
+#include "music.h"
+#include "spsc.h"
+#include "log.h"
 #include <SDL_mixer.h>
 
-bool initAudio()
+// Buffer sizes requested by openAudioDevice(), smallest first. 256 samples is
+// ~6ms at 44.1kHz; the last entry is the old fixed size. The device may
+// substitute its own size and rate, so what it actually runs at is read back
+// from Mix_QuerySpec and the post-mix callback.
+static const int LOW_LATENCY_BUFFERS[] = { 256, 512, 1024, 2048 };
+static const int COMPAT_BUFFER = 2048;
+
+static SDL_atomic_t audioBufferSamples;
+static int deviceFrequency = 0;
+static int deviceFrameBytes = 0;
+static bool audioDeviceOpen = false;
+
+// Everything the game asks of the mixer goes through this queue. The main
+// thread is the only producer and the audio service thread the only
+// consumer, so posting never waits on the mixer lock.
+enum AudioCommandType {
+    AUDIO_PLAY_SFX,
+    AUDIO_CHUNK_VOLUME,
+    AUDIO_PLAY_MUSIC
+};
+
+struct AudioCommand {
+    AudioCommandType type;
+    Mix_Chunk* chunk;
+    int value;          // Priority, volume or MusicTrack.
+    Uint64 issuedAt;
+};
+
+static SpscQueue<AudioCommand, 256> audioCommands;
+static SDL_sem* commandsReady = nullptr;
+static SDL_Thread* serviceThread = nullptr;
+static SDL_atomic_t serviceStopping;
+static bool nullSink = false;
+
+// One slot per mixer channel, owned by the service thread. A new effect
+// takes a free voice, or steals the oldest voice of the lowest priority not
+// above its own.
+struct Voice {
+    int priority;
+    Uint32 startedAt;
+};
+static Voice voices[SFX_VOICE_COUNT];
+static SDL_atomic_t busyVoices;
+static SDL_atomic_t droppedSFX;
+
+// Trigger-to-output latency. The trigger is stamped when the game posts
+// the command; the post-mix hook, which runs on the audio thread right
+// after the effect is first mixed, adds the device time of the buffer it
+// was handed and records the sample.
+static const int LATENCY_SAMPLES = 64;
+static SDL_SpinLock latencyLock = 0;
+static Uint64 pendingTrigger = 0;
+static double latencySamples[LATENCY_SAMPLES];
+static int latencyCount = 0;
+static int latencyNext = 0;
+
+static void postMixCallback(void*, Uint8*, int len)
 {
-    // Boosters SFX
-    hammerSound = Mix_LoadWAV("assets/music and sfx/thorhammer.wav");
-    if (!hammerSound){
-        std::cerr << "Failed to load hammer sound: " << Mix_GetError() << "\n";
+    int samples = len / deviceFrameBytes;
+    SDL_AtomicSet(&audioBufferSamples, samples);
+
+    SDL_AtomicLock(&latencyLock);
+    if (pendingTrigger != 0) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        double mixedMs = (now - pendingTrigger) * 1000.0 / SDL_GetPerformanceFrequency();
+        double bufferMs = samples * 1000.0 / deviceFrequency;
+        latencySamples[latencyNext] = mixedMs + bufferMs;
+        latencyNext = (latencyNext + 1) % LATENCY_SAMPLES;
+        if (latencyCount < LATENCY_SAMPLES)
+            latencyCount++;
+        pendingTrigger = 0;
     }
+    SDL_AtomicUnlock(&latencyLock);
+}
 
-    freezeSound = Mix_LoadWAV("assets/music and sfx/freeze.wav");
-    if (!freezeSound){
-        std::cerr << "Failed to load freeze sound: " << Mix_GetError() << "\n";
+bool openAudioDevice(bool lowLatency)
+{
+    for (int samples : LOW_LATENCY_BUFFERS) {
+        if (!lowLatency && samples != COMPAT_BUFFER)
+            continue;
+        if (Mix_OpenAudioDevice(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, samples, nullptr,
+                                SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE) == 0) {
+            Uint16 format = 0;
+            int channels = 0;
+            if (!Mix_QuerySpec(&deviceFrequency, &format, &channels)) {
+                LOG_WARN(LOG_AUDIO, "Could not query the audio device: %s", Mix_GetError());
+                Mix_CloseAudio();
+                continue;
+            }
+            deviceFrameBytes = SDL_AUDIO_BITSIZE(format) / 8 * channels;
+            // Until the first callback reports the real size, assume the request.
+            SDL_AtomicSet(&audioBufferSamples, samples);
+            LOG_INFO(LOG_AUDIO, "Audio device open: %d Hz, %d channels, %d-sample buffer requested",
+                     deviceFrequency, channels, samples);
+            audioDeviceOpen = true;
+            Mix_AllocateChannels(SFX_VOICE_COUNT);
+            Mix_SetPostMix(postMixCallback, nullptr);
+            return true;
+        }
+        LOG_WARN(LOG_AUDIO, "Audio buffer of %d samples rejected: %s", samples, Mix_GetError());
     }
+    return false;
+}
 
-    tsunamiSound = Mix_LoadWAV("assets/music and sfx/tsunami.wav");
-    if (!tsunamiSound){
-        std::cerr << "Failed to load tsunami sound: " << Mix_GetError() << "\n";
+static void startEffect(const AudioCommand& command)
+{
+    int channel = -1;
+    int playing = 0;
+    for (int i = 0; i < SFX_VOICE_COUNT; i++) {
+        if (Mix_Playing(i))
+            playing++;
+        else if (channel < 0)
+            channel = i;
+    }
+    if (channel < 0) {
+        for (int i = 0; i < SFX_VOICE_COUNT; i++) {
+            if (voices[i].priority > command.value)
+                continue;
+            if (channel < 0 || voices[i].priority < voices[channel].priority ||
+                (voices[i].priority == voices[channel].priority && voices[i].startedAt < voices[channel].startedAt))
+                channel = i;
+        }
+        if (channel < 0) {
+            SDL_AtomicIncRef(&droppedSFX);
+            return;
+        }
+        Mix_HaltChannel(channel);
+        playing--;
     }
 
-    bgMusic = Mix_LoadMUS("assets/music and sfx/linga guli guli.mp3");
-    if (!bgMusic) {
-        std::cerr << "Failed to load bgMusic: " << Mix_GetError() << "\n";
-        return false;
+    voices[channel].priority = command.value;
+    voices[channel].startedAt = SDL_GetTicks();
+    SDL_AtomicSet(&busyVoices, playing + 1);
+
+    SDL_AtomicLock(&latencyLock);
+    if (pendingTrigger == 0)
+        pendingTrigger = command.issuedAt;
+    SDL_AtomicUnlock(&latencyLock);
+
+    Mix_PlayChannel(channel, command.chunk, 0);
+}
+
+static void runCommand(const AudioCommand& command)
+{
+    switch (command.type) {
+        case AUDIO_PLAY_SFX:
+            startEffect(command);
+            break;
+        case AUDIO_CHUNK_VOLUME:
+            Mix_VolumeChunk(command.chunk, command.value);
+            break;
+        case AUDIO_PLAY_MUSIC:
+            playMusicTrack((MusicTrack)command.value);
+            break;
     }
-    else{
-        MusicFinishedCallback();
+}
+
+static int audioService(void*)
+{
+    AudioCommand command;
+    while (!SDL_AtomicGet(&serviceStopping)) {
+        SDL_SemWaitTimeout(commandsReady, 100);
+        while (audioCommands.pop(command)) {
+            if (!nullSink)
+                runCommand(command);
+        }
     }
-    gameWinMusic = Mix_LoadMUS("assets/music and sfx/congratulation.mp3");
-    if (!gameWinMusic) {
-        std::cerr << "Failed to load gameWinMusic: " << Mix_GetError() << "\n";
+    return 0;
+}
+
+static void postCommand(AudioCommandType type, Mix_Chunk* chunk, int value)
+{
+    if (!serviceThread)
+        return;
+    AudioCommand command = { type, chunk, value, SDL_GetPerformanceCounter() };
+    if (!audioCommands.push(command)) {
+        if (type == AUDIO_PLAY_SFX)
+            SDL_AtomicIncRef(&droppedSFX);
+        return;
     }
-    congratsMusic = Mix_LoadMUS("assets/music and sfx/newrec.mp3");
-    if (!congratsMusic) {
-        std::cerr << "Failed to load congratsMusic: " << Mix_GetError() << "\n";
+    SDL_SemPost(commandsReady);
+}
+
+static void startAudioService()
+{
+    if (serviceThread)
+        return;
+    // Without a mixer (no device, or --no-audio) the queue still runs but
+    // commands are discarded.
+    nullSink = !audioDeviceOpen;
+    SDL_AtomicSet(&serviceStopping, 0);
+    commandsReady = SDL_CreateSemaphore(0);
+    serviceThread = SDL_CreateThread(audioService, "AudioService", nullptr);
+    if (!serviceThread)
+        LOG_ERROR(LOG_AUDIO, "Failed to start audio service: %s", SDL_GetError());
+}
+
+static void stopAudioService()
+{
+    if (serviceThread) {
+        SDL_AtomicSet(&serviceStopping, 1);
+        SDL_SemPost(commandsReady);
+        SDL_WaitThread(serviceThread, nullptr);
+        serviceThread = nullptr;
     }
-    swipeSound = Mix_LoadWAV("assets/music and sfx/switch.wav");
-    if (!swipeSound) {
-        std::cerr << "Failed to load swipeSound: " << Mix_GetError() << "\n";
+    if (commandsReady) {
+        SDL_DestroySemaphore(commandsReady);
+        commandsReady = nullptr;
     }
-    gameOverSound = Mix_LoadWAV("assets/music and sfx/gameover.wav");
-    if (!gameOverSound) {
-        std::cerr << "Failed to load gameOverSound: " << Mix_GetError() << "\n";
+}
+
+void playSFX(Mix_Chunk* chunk, SfxPriority priority)
+{
+    if (chunk)
+        postCommand(AUDIO_PLAY_SFX, chunk, priority);
+}
+
+int audioBufferSize()
+{
+    return SDL_AtomicGet(&audioBufferSamples);
+}
+
+int audioFrequency()
+{
+    return deviceFrequency;
+}
+
+bool sfxLatencyStats(double* averageMs, double* maxMs)
+{
+    SDL_AtomicLock(&latencyLock);
+    int count = latencyCount;
+    double sum = 0.0, worst = 0.0;
+    for (int i = 0; i < count; i++) {
+        sum += latencySamples[i];
+        if (latencySamples[i] > worst)
+            worst = latencySamples[i];
     }
+    SDL_AtomicUnlock(&latencyLock);
+    if (count == 0)
+        return false;
+    *averageMs = sum / count;
+    *maxMs = worst;
+    return true;
+}
+
+int activeVoices()
+{
+    return SDL_AtomicGet(&busyVoices);
+}
+
+int droppedSFXCount()
+{
+    return SDL_AtomicGet(&droppedSFX);
+}
+
+bool audioEnabled()
+{
+    return audioDeviceOpen;
+}
+
+bool initAudio()
+{
+    // The streamer goes first so the service thread never sees it half set up.
+    if (audioDeviceOpen)
+        startMusicStreamer();
+    startAudioService();
+    if (!audioDeviceOpen)
+        return true;
+
+    // Chunks and music decode on the asset workers; volumes are reapplied as
+    // each chunk arrives since setSFXVolume only touches loaded ones.
+    auto chunkSlot = [](Mix_Chunk** slot) {
+        return [slot](Mix_Chunk* chunk) {
+            *slot = chunk;
+            setSFXVolume(sfxVolume);
+        };
+    };
+
+    // Boosters SFX
+    requestChunk("assets/music and sfx/thorhammer.wav", chunkSlot(&hammerSound));
+    requestChunk("assets/music and sfx/freeze.wav", chunkSlot(&freezeSound));
+    requestChunk("assets/music and sfx/tsunami.wav", chunkSlot(&tsunamiSound));
+
+    requestChunk("assets/music and sfx/switch.wav", chunkSlot(&swipeSound));
+    requestChunk("assets/music and sfx/gameover.wav", chunkSlot(&gameOverSound));
 
     setMusicVolume(musicVolume);
-    setSFXVolume(sfxVolume);
+    playBackgroundMusic();
 
     return true;
 }
 
 void cleanupAudio()
 {
+    stopAudioService();
+
     if (hammerSound)     { Mix_FreeChunk(hammerSound);     hammerSound = nullptr; }
     if (freezeSound)     { Mix_FreeChunk(freezeSound);     freezeSound = nullptr; }
     if (tsunamiSound)    { Mix_FreeChunk(tsunamiSound);    tsunamiSound = nullptr; }
 
-    if (bgMusic)         { Mix_FreeMusic(bgMusic);         bgMusic = nullptr; }
-    if (gameWinMusic)    { Mix_FreeMusic(gameWinMusic);    gameWinMusic = nullptr; }
-    if (congratsMusic)   { Mix_FreeMusic(congratsMusic);   congratsMusic = nullptr; }
+    stopMusicStreamer();
 
     if (swipeSound)      { Mix_FreeChunk(swipeSound);      swipeSound = nullptr; }
     if (gameOverSound)   { Mix_FreeChunk(gameOverSound);   gameOverSound = nullptr; }
 }
 
-void MusicFinishedCallback() {
-    if (bgMusic) {
-        Mix_PlayMusic(bgMusic, -1);
-    }
+void playBackgroundMusic()
+{
+    prefetchMusicTrack(MUSIC_BACKGROUND);
+    postCommand(AUDIO_PLAY_MUSIC, nullptr, MUSIC_BACKGROUND);
 }
 
 void stopMusic()
 {
-    Mix_HaltMusic();
+    postCommand(AUDIO_PLAY_MUSIC, nullptr, MUSIC_NONE);
 }
 
 void playGameWinMusic()
 {
-    if (gameWinMusic) {
-        Mix_PlayMusic(gameWinMusic, -1); // or loop once if you prefer
-    }
+    prefetchMusicTrack(MUSIC_WIN);
+    postCommand(AUDIO_PLAY_MUSIC, nullptr, MUSIC_WIN);
 }
 
 void playCongratsMusic()
 {
-    if (congratsMusic) {
-        Mix_PlayMusic(congratsMusic, 1); // play once
-    }
+    prefetchMusicTrack(MUSIC_RECORD);
+    postCommand(AUDIO_PLAY_MUSIC, nullptr, MUSIC_RECORD);
+}
+
+void prefetchGameWinMusic()
+{
+    prefetchMusicTrack(MUSIC_WIN);
+}
+
+void prefetchCongratsMusic()
+{
+    prefetchMusicTrack(MUSIC_RECORD);
 }
 
 void playSwipeSFX()
 {
-    if (swipeSound) {
-        Mix_PlayChannel(-1, swipeSound, 0);
-    }
+    playSFX(swipeSound, SFX_PRIORITY_MOVE);
 }
 
 void playGameOverSFX()
 {
-    if (gameOverSound) {
-        Mix_PlayChannel(-1, gameOverSound, 0);
-    }
+    playSFX(gameOverSound, SFX_PRIORITY_CRITICAL);
 }
 
 void setMusicVolume(int volume)
 {
     musicVolume = volume;
     int sdlVolume = (volume * 128) / 100;
-    Mix_VolumeMusic(sdlVolume);
+    setMusicStreamVolume(sdlVolume);
 }
 
 void setSFXVolume(int volume)
 {
     sfxVolume = volume;
     int sdlVolume = (volume * 128) / 100;
-    if (swipeSound)    Mix_VolumeChunk(swipeSound, sdlVolume);
-    if (gameOverSound) Mix_VolumeChunk(gameOverSound, sdlVolume);
+    if (swipeSound)    postCommand(AUDIO_CHUNK_VOLUME, swipeSound, sdlVolume);
+    if (gameOverSound) postCommand(AUDIO_CHUNK_VOLUME, gameOverSound, sdlVolume);
 }
@@ -2,9 +2,30 @@
 #define AUDIO_H
 #include <SDL_mixer.h>
 
-bool initAudio();
+// Requested mixer output format. tools/packassets pre-converts sound effects
+// to it; the device may still pick another rate, see audioFrequency().
+const int AUDIO_FREQUENCY = 44100;
+const int AUDIO_CHANNELS = 2;
+
+// Size of the fixed sound effect voice pool (mixer channels).
+const int SFX_VOICE_COUNT = 8;
+
+// Higher priorities may steal voices from lower ones when the pool is full.
+enum SfxPriority {
+    SFX_PRIORITY_MOVE = 0,
+    SFX_PRIORITY_BOOSTER = 1,
+    SFX_PRIORITY_CRITICAL = 2
+};
 
-void MusicFinishedCallback();
+// Opens the mixer. In low-latency mode the smallest buffer is requested first;
+// otherwise the original 2048-sample buffer. The device is allowed to change
+// the rate and buffer size it was asked for.
+bool openAudioDevice(bool lowLatency);
+
+// Starts the audio service thread and queues the sound files for loading.
+// All playback and volume calls below are posted to the service and return
+// immediately. Must be called from the main thread, like those calls.
+bool initAudio();
 
 void cleanupAudio();
 
@@ -16,10 +37,29 @@ void playGameWinMusic();
 
 void playCongratsMusic();
 
+// Start loading a track ahead of the moment it is expected to play.
+void prefetchGameWinMusic();
+
+void prefetchCongratsMusic();
+
 void playSwipeSFX();
 
 void playGameOverSFX();
 
+// Queues an effect for the voice pool. Never blocks; the effect is dropped
+// if every voice is busy with something more important.
+void playSFX(Mix_Chunk* chunk, SfxPriority priority);
+
+// False when running without an audio device; audio calls are then no-ops.
+bool audioEnabled();
+
+// Diagnostics. Buffer size and rate are what the device actually runs at.
+int audioBufferSize();
+int audioFrequency();
+bool sfxLatencyStats(double* averageMs, double* maxMs);
+int activeVoices();
+int droppedSFXCount();
+
 void setMusicVolume(int volume);
 
 void setSFXVolume(int volume);
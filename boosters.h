@@ -29,16 +29,18 @@ extern Mix_Chunk* tsunamiSound;
 extern bool hammerActive;
 extern bool freezeActive;
 extern bool tsunamiActive;
-extern Uint32 freezeStartTime;
 const Uint32 FREEZE_DURATION = 30000; // 30 seconds
 
+// Timer callback that ends the freeze booster.
+void freezeExpired();
+
 // Extern declarations for the booster buttons.
 extern BoosterButton hammerButton;
 extern BoosterButton freezeButton;
 extern BoosterButton tsunamiButton;
 extern BoosterType currentBoosterType;
 
-// Loads PNG textures for the booster icons. Returns true if successful.
+// Queues the booster icon PNGs on the asset loader.
 bool loadBoosterTextures(SDL_Renderer* renderer);
 
 // Frees all booster-related textures.
@@ -51,12 +53,13 @@ void drawBoosterIcons(SDL_Renderer* renderer);
 // It loads a specific cursor image based on the booster type.
 SDL_Cursor* setBoosterCursor(SDL_Renderer* renderer, BoosterButton button);
 
-// Handles a click on the hammer booster icon. Call this from your mouse event handling.
-void handleHammerBoosterClick(int mouseX, int mouseY, SDL_Renderer* renderer);
+// Handles a click on the hammer booster icon. Call this once the UI hit-test
+// has resolved the click to WIDGET_HAMMER.
+void handleHammerBoosterClick(SDL_Renderer* renderer);
 
-void handleFreezeBoosterClick(int mouseX, int mouseY, SDL_Renderer* renderer);
+void handleFreezeBoosterClick(SDL_Renderer* renderer);
 
-void handleTsunamiBoosterClick(int mouseX, int mouseY, SDL_Renderer* renderer);
+void handleTsunamiBoosterClick(SDL_Renderer* renderer);
 
 void useHammerBoosterOnTile(int mouseX, int mouseY);
 
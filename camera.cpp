@@ -0,0 +1,85 @@
+#include "camera.h"
+#include "globals.h"
+#include "softrender.h"
+#include <algorithm>
+
+static float zoom = 1.0f;
+// Top left of the view, in zoomed board pixels.
+static int viewX = 0;
+static int viewY = 0;
+
+static float maxZoom()
+{
+    return std::max(1.0f, (float)GRID_SIZE / CLASSIC_GRID_SIZE);
+}
+
+static void clampView()
+{
+    int slack = cameraTileSize() * GRID_SIZE - GAME_AREA_WIDTH;
+    viewX = std::max(0, std::min(viewX, slack));
+    viewY = std::max(0, std::min(viewY, slack));
+}
+
+void resetCamera()
+{
+    zoom = 1.0f;
+    viewX = viewY = 0;
+}
+
+int cameraTileSize()
+{
+    return (int)(TILE_SIZE * zoom);
+}
+
+void zoomCamera(float factor, int x, int y)
+{
+    float next = std::max(1.0f, std::min(zoom * factor, maxZoom()));
+    if (next == zoom)
+        return;
+    int before = cameraTileSize();
+    zoom = next;
+    int after = cameraTileSize();
+    viewX = (int)((viewX + x) * (float)after / before) - x;
+    viewY = (int)((viewY + y) * (float)after / before) - y;
+    clampView();
+    // Tiles are pre-scaled per size on the software path; the old size is dead.
+    if (softwareRendering())
+        freeScaledCopies();
+}
+
+void panCamera(int dx, int dy)
+{
+    viewX -= dx;
+    viewY -= dy;
+    clampView();
+}
+
+SDL_Rect cameraCellRect(int row, int col)
+{
+    int size = cameraTileSize();
+    SDL_Rect rect = { col * size - viewX, row * size - viewY, size, size };
+    return rect;
+}
+
+void cameraVisibleCells(int* row0, int* row1, int* col0, int* col1)
+{
+    int size = cameraTileSize();
+    if (size <= 0) {
+        *row0 = *row1 = *col0 = *col1 = 0;
+        return;
+    }
+    *row0 = viewY / size;
+    *col0 = viewX / size;
+    *row1 = std::min(GRID_SIZE, (viewY + GAME_AREA_WIDTH + size - 1) / size);
+    *col1 = std::min(GRID_SIZE, (viewX + GAME_AREA_WIDTH + size - 1) / size);
+}
+
+bool cameraCellAt(int x, int y, int* row, int* col)
+{
+    int size = cameraTileSize();
+    if (size <= 0 || x < 0 || x >= GAME_AREA_WIDTH || y < 0 || y >= GAME_AREA_WIDTH)
+        return false;
+    *row = (viewY + y) / size;
+    *col = (viewX + x) / size;
+    return *row < GRID_SIZE && *col < GRID_SIZE;
+}
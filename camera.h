@@ -0,0 +1,36 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <SDL.h>
+
+// The view of the board inside the game area. At zoom 1 the whole board
+// fits, as it always has; zooming in is capped so a tile never gets bigger
+// than on the classic board, so the camera only moves on large boards.
+// Panning is clamped so the board always covers the view.
+
+// Zoom change per mouse wheel notch.
+const float CAMERA_ZOOM_STEP = 1.25f;
+
+// Zoom 1, top left. Call when the board size or layout changes.
+void resetCamera();
+
+// Zooms in (factor > 1) or out, keeping the cell under (x, y) in place.
+void zoomCamera(float factor, int x, int y);
+
+// Moves the view by a drag of (dx, dy) pixels.
+void panCamera(int dx, int dy);
+
+// On-screen size of a tile at the current zoom.
+int cameraTileSize();
+
+// Where a cell lands on screen; may lie partly or wholly outside the view.
+SDL_Rect cameraCellRect(int row, int col);
+
+// Rows [*row0, *row1) and columns [*col0, *col1) that are at least partly
+// in view.
+void cameraVisibleCells(int* row0, int* row1, int* col0, int* col1);
+
+// The cell under a point; false if the point is off the board.
+bool cameraCellAt(int x, int y, int* row, int* col);
+
+#endif // CAMERA_H
@@ -0,0 +1,298 @@
+#include "capture.h"
+#include "log.h"
+#include "video.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Enough to ride out a slow write without the main thread noticing.
+static const int CAPTURE_BUFFERS = 8;
+static const Uint32 CAPTURE_MAX_HOLD_FRAMES = CAPTURE_FPS;
+
+// A buffer goes round: read back by the main thread, converted by whichever
+// converter takes it, written by the writer in capture order, then free.
+enum BufferState {
+    BUFFER_FREE,
+    BUFFER_CAPTURED,
+    BUFFER_CONVERTING,
+    BUFFER_CONVERTED
+};
+
+struct CaptureBuffer {
+    std::vector<Uint8> pixels;  // ARGB8888, captureW * 4 bytes a row.
+    std::vector<Uint8> planes;
+    Uint32 ticks;
+    Uint32 sequence;
+    BufferState state;
+};
+
+static CaptureBuffer buffers[CAPTURE_BUFFERS];
+// Guards buffer states and the sequence counters; held only to flip them.
+static SDL_mutex* bufferMutex = nullptr;
+static SDL_cond* bufferChanged = nullptr;
+static SDL_Thread* writerThread = nullptr;
+static std::vector<SDL_Thread*> converterThreads;
+static bool stopping = false;
+static Uint32 nextSequence = 0;     // Next frame the main thread captures.
+static Uint32 writeSequence = 0;    // Next frame the writer writes.
+static SDL_atomic_t framesWritten;
+static Y4mFile video;           // The writer's while it runs.
+static int downscale = 1;
+static int captureW = 0;
+static int captureH = 0;
+static Uint32 startTicks = 0;
+static int framesCaptured = 0;
+static int framesSkipped = 0;
+
+static int captureConverter(void*)
+{
+    SDL_LockMutex(bufferMutex);
+    while (true) {
+        CaptureBuffer* job = nullptr;
+        for (CaptureBuffer& b : buffers) {
+            if (b.state == BUFFER_CAPTURED) {
+                job = &b;
+                break;
+            }
+        }
+        if (!job) {
+            if (stopping)
+                break;
+            SDL_CondWait(bufferChanged, bufferMutex);
+            continue;
+        }
+        job->state = BUFFER_CONVERTING;
+        SDL_UnlockMutex(bufferMutex);
+        convertFrame(job->pixels.data(), captureW * 4, captureW, captureH, downscale, job->planes.data());
+        SDL_LockMutex(bufferMutex);
+        job->state = BUFFER_CONVERTED;
+        SDL_CondBroadcast(bufferChanged);
+    }
+    SDL_UnlockMutex(bufferMutex);
+    return 0;
+}
+
+// The converted buffer holding frame sequence, or nullptr.
+static CaptureBuffer* convertedFrame(Uint32 sequence)
+{
+    for (CaptureBuffer& b : buffers) {
+        if (b.state == BUFFER_CONVERTED && b.sequence == sequence)
+            return &b;
+    }
+    return nullptr;
+}
+
+static int captureWriter(void*)
+{
+    std::vector<Uint8> held(y4mFrameBytes(video.width, video.height));
+    bool pending = false;       // held is a picture not yet written.
+    Uint32 pendingSlot = 0;
+    bool failed = false;
+
+    SDL_LockMutex(bufferMutex);
+    while (true) {
+        CaptureBuffer* buffer = convertedFrame(writeSequence);
+        if (!buffer) {
+            if (stopping && writeSequence == nextSequence)
+                break;
+            SDL_CondWait(bufferChanged, bufferMutex);
+            continue;
+        }
+        SDL_UnlockMutex(bufferMutex);
+
+        Uint32 slot = (Uint32)((Uint64)(buffer->ticks - startTicks) * CAPTURE_FPS / 1000);
+        // The last picture stays on screen until this one's slot. A frame in
+        // the same slot replaces it.
+        if (pending && slot > pendingSlot) {
+            Uint32 repeats = SDL_min(slot - pendingSlot, CAPTURE_MAX_HOLD_FRAMES);
+            for (Uint32 n = 0; n < repeats && !failed; n++) {
+                failed = !writeY4mFrame(video, held.data());
+            }
+        }
+        std::memcpy(held.data(), buffer->planes.data(), held.size());
+        pending = true;
+        pendingSlot = slot;
+        SDL_AtomicSet(&framesWritten, (int)video.frames);
+
+        SDL_LockMutex(bufferMutex);
+        buffer->state = BUFFER_FREE;
+        writeSequence++;
+    }
+    SDL_UnlockMutex(bufferMutex);
+
+    if (pending && !failed)
+        failed = !writeY4mFrame(video, held.data());
+    if (failed)
+        LOG_ERROR(LOG_RENDER, "Writing the recording failed; it stops after %u frames.", video.frames);
+    SDL_AtomicSet(&framesWritten, (int)video.frames);
+    closeY4m(video);
+    return 0;
+}
+
+static std::string recordingPath()
+{
+#ifdef _WIN32
+    _mkdir(CAPTURE_DIR);
+#else
+    mkdir(CAPTURE_DIR, 0755);
+#endif
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+    return std::string(CAPTURE_DIR) + "/2048-" + stamp + ".y4m";
+}
+
+static void stopThreads()
+{
+    SDL_LockMutex(bufferMutex);
+    stopping = true;
+    SDL_CondBroadcast(bufferChanged);
+    SDL_UnlockMutex(bufferMutex);
+    for (SDL_Thread* thread : converterThreads) {
+        SDL_WaitThread(thread, nullptr);
+    }
+    converterThreads.clear();
+    if (writerThread)
+        SDL_WaitThread(writerThread, nullptr);
+    writerThread = nullptr;
+    SDL_DestroyCond(bufferChanged);
+    SDL_DestroyMutex(bufferMutex);
+    bufferChanged = nullptr;
+    bufferMutex = nullptr;
+    for (CaptureBuffer& b : buffers) {
+        std::vector<Uint8>().swap(b.pixels);
+        std::vector<Uint8>().swap(b.planes);
+    }
+}
+
+static void startCapture(SDL_Renderer* renderer)
+{
+    SDL_GetRendererOutputSize(renderer, &captureW, &captureH);
+    std::string path = recordingPath();
+    if (!openY4m(video, path.c_str(), downscaledSize(captureW, downscale), downscaledSize(captureH, downscale),
+                 CAPTURE_FPS))
+        return;
+
+    for (CaptureBuffer& b : buffers) {
+        b.pixels.resize((size_t)captureW * captureH * 4);
+        b.planes.resize(y4mFrameBytes(video.width, video.height));
+        b.state = BUFFER_FREE;
+    }
+    startTicks = SDL_GetTicks();
+    framesCaptured = 0;
+    framesSkipped = 0;
+    nextSequence = 0;
+    writeSequence = 0;
+    stopping = false;
+    SDL_AtomicSet(&framesWritten, 0);
+    bufferMutex = SDL_CreateMutex();
+    bufferChanged = SDL_CreateCond();
+
+    // The main thread reads frames back and one thread writes; the other
+    // cores convert.
+    int converters = SDL_max(1, SDL_GetCPUCount() - 2);
+    writerThread = SDL_CreateThread(captureWriter, "CaptureWriter", nullptr);
+    for (int n = 0; n < converters && writerThread; n++) {
+        SDL_Thread* thread = SDL_CreateThread(captureConverter, "CaptureConverter", nullptr);
+        if (thread)
+            converterThreads.push_back(thread);
+    }
+    if (!writerThread || converterThreads.empty()) {
+        LOG_ERROR(LOG_RENDER, "Failed to start the capture threads: %s", SDL_GetError());
+        bool writerStarted = writerThread != nullptr;
+        stopThreads();
+        // Only the writer closes the video; without one, drop the empty file.
+        if (!writerStarted) {
+            closeY4m(video);
+            std::remove(path.c_str());
+        }
+        return;
+    }
+    LOG_INFO(LOG_RENDER, "Recording %dx%d to %s with %d converters.", video.width, video.height, path.c_str(),
+             (int)converterThreads.size());
+}
+
+void stopCapture()
+{
+    if (!writerThread)
+        return;
+    stopThreads();
+    LOG_INFO(LOG_RENDER, "Recording stopped: %d frames captured, %d skipped while the encoder caught up, %d written.",
+             framesCaptured, framesSkipped, SDL_AtomicGet(&framesWritten));
+}
+
+void toggleCapture(SDL_Renderer* renderer)
+{
+    if (writerThread)
+        stopCapture();
+    else
+        startCapture(renderer);
+}
+
+bool capturing()
+{
+    return writerThread != nullptr;
+}
+
+void setCaptureDownscale(int factor)
+{
+    downscale = SDL_max(1, factor);
+}
+
+void captureFrame(SDL_Renderer* renderer)
+{
+    if (!writerThread)
+        return;
+    int w, h;
+    SDL_GetRendererOutputSize(renderer, &w, &h);
+    if (w != captureW || h != captureH) {
+        // A video has one size; the new one goes to the next file.
+        stopCapture();
+        startCapture(renderer);
+        if (!writerThread)
+            return;
+    }
+
+    // Only this thread takes free buffers, so the one found stays ours.
+    CaptureBuffer* buffer = nullptr;
+    SDL_LockMutex(bufferMutex);
+    for (CaptureBuffer& b : buffers) {
+        if (b.state == BUFFER_FREE) {
+            buffer = &b;
+            break;
+        }
+    }
+    SDL_UnlockMutex(bufferMutex);
+    if (!buffer) {
+        framesSkipped++;
+        return;
+    }
+    if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, buffer->pixels.data(), captureW * 4) != 0) {
+        LOG_WARN(LOG_RENDER, "Could not read the frame back, recording stopped: %s", SDL_GetError());
+        stopCapture();
+        return;
+    }
+
+    SDL_LockMutex(bufferMutex);
+    buffer->ticks = SDL_GetTicks();
+    buffer->sequence = nextSequence++;
+    buffer->state = BUFFER_CAPTURED;
+    SDL_CondBroadcast(bufferChanged);
+    SDL_UnlockMutex(bufferMutex);
+    framesCaptured++;
+}
+
+void captureStats(int* captured, int* written, int* skipped)
+{
+    *captured = framesCaptured;
+    *written = SDL_AtomicGet(&framesWritten);
+    *skipped = framesSkipped;
+}
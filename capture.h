@@ -0,0 +1,36 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <SDL.h>
+
+// Gameplay recording (F9). Each presented frame is read back into one of a
+// fixed pool of buffers allocated when recording starts. Converter threads,
+// one per spare core, turn frames to YUV in parallel and a writer thread
+// appends them in order to a 4:4:4 .y4m video in CAPTURE_DIR. The main
+// thread never waits for them: when every buffer is still in flight the
+// frame is not read back and the video holds the previous picture.
+//
+// Frames are placed on a CAPTURE_FPS timeline by when they were presented,
+// so the video plays in real time; pictures that stand still for longer
+// than a second are cut to a second.
+
+const char* const CAPTURE_DIR = "recordings";
+const int CAPTURE_FPS = 60;
+
+void toggleCapture(SDL_Renderer* renderer);
+bool capturing();
+
+// Frames are shrunk this many times in each direction (--record-downscale).
+void setCaptureDownscale(int downscale);
+
+// Call once the frame is drawn and before it is presented.
+void captureFrame(SDL_Renderer* renderer);
+
+// Finishes the video; waits for the frames still queued.
+void stopCapture();
+
+// Frames handed to the encoder, written to the video (holds included) and
+// not read back because the encoder was behind.
+void captureStats(int* captured, int* written, int* skipped);
+
+#endif // CAPTURE_H
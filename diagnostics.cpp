@@ -0,0 +1,140 @@
+#include "diagnostics.h"
+#include "audio.h"
+#include "capture.h"
+#include "drawlist.h"
+#include "globals.h"
+#include "latency.h"
+#include "music.h"
+#include "quality.h"
+#include "softrender.h"
+#include "textures.h"
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool visible = false;
+
+void toggleDiagnostics()
+{
+    visible = !visible;
+}
+
+bool diagnosticsVisible()
+{
+    return visible;
+}
+
+static std::vector<std::string> diagnosticLines()
+{
+    std::vector<std::string> lines;
+    std::ostringstream line;
+
+    if (audioFrequency() > 0) {
+        line << "Audio buffer: " << audioBufferSize() << " samples @ " << audioFrequency() << " Hz ("
+             << std::fixed << std::setprecision(1)
+             << audioBufferSize() * 1000.0 / audioFrequency() << " ms)";
+    } else {
+        line << "Audio buffer: none";
+    }
+    lines.push_back(line.str());
+
+    double averageMs = 0.0, maxMs = 0.0;
+    line.str("");
+    if (sfxLatencyStats(&averageMs, &maxMs))
+        line << "SFX latency: avg " << averageMs << " ms, max " << maxMs << " ms";
+    else
+        line << "SFX latency: no samples yet";
+    lines.push_back(line.str());
+
+    line.str("");
+    line << "Voices: " << activeVoices() << "/" << SFX_VOICE_COUNT
+         << ", dropped " << droppedSFXCount();
+    lines.push_back(line.str());
+
+    Uint32 p50, p95, p99;
+    line.str("");
+    if (inputLatencyPercentiles(&p50, &p95, &p99))
+        line << "Input to present: p50 " << p50 << " ms, p95 " << p95 << " ms, p99 " << p99 << " ms";
+    else
+        line << "Input to present: no samples yet";
+    lines.push_back(line.str());
+
+    line.str("");
+    line << "Music: " << musicBufferedMs() << " ms buffered, "
+         << musicUnderruns() << " underruns";
+    lines.push_back(line.str());
+
+    if (softwareRendering()) {
+        int rects = 0, percent = 0;
+        softwarePresentStats(&rects, &percent);
+        line.str("");
+        line << "Software present: " << rects << " rects, " << percent << "% of window";
+        lines.push_back(line.str());
+    }
+
+    const double MB = 1024.0 * 1024.0;
+    line.str("");
+    line << "Textures: " << totalTextureBytes() / MB << "/" << textureBudget() / MB << " MB (";
+    for (int c = 0; c < TEXTURE_CATEGORY_COUNT; c++) {
+        line << (c ? ", " : "") << textureCategoryName((TextureCategory)c) << " "
+             << textureBytes((TextureCategory)c) / MB;
+    }
+    line << ")";
+    lines.push_back(line.str());
+
+    int commands = 0, calls = 0;
+    drawListStats(&commands, &calls);
+    line.str("");
+    line << "Draw list: " << commands << " commands in " << calls << " calls";
+    lines.push_back(line.str());
+
+    int level = 0;
+    float frameMs = 0, budgetMs = 0;
+    qualityStats(&level, &frameMs, &budgetMs);
+    line.str("");
+    line << "Quality: level " << level << " ("
+         << (int)(renderScale() * 100) << "% game area" << (backgroundArtEnabled() ? "" : ", no background")
+         << "), frame " << frameMs << "/" << budgetMs << " ms";
+    lines.push_back(line.str());
+
+    if (capturing()) {
+        int captured = 0, written = 0, skipped = 0;
+        captureStats(&captured, &written, &skipped);
+        line.str("");
+        line << "Recording: " << captured << " frames captured, " << written << " written, "
+             << skipped << " skipped";
+        lines.push_back(line.str());
+    }
+
+    return lines;
+}
+
+void drawDiagnostics(SDL_Renderer* renderer)
+{
+    // The smallest game font, so the panel leaves most of the board visible.
+    if (!visible || !valueFont)
+        return;
+
+    std::vector<std::string> lines = diagnosticLines();
+    SDL_Color white = { 255, 255, 255, 255 };
+    std::vector<FrameText> texts;
+    int widest = 0;
+    for (const std::string& line : lines) {
+        texts.push_back(frameText(renderer, valueFont, line.c_str(), white, true));
+        widest = std::max(widest, texts.back().w);
+    }
+
+    // Sized to the widest line, so new lines never run past the edge.
+    int lineHeight = TTF_FontLineSkip(valueFont);
+    SDL_Rect panel = { 10, 10, widest + 16, (int)lines.size() * lineHeight + 16 };
+    queueFill(LAYER_OVERLAY, { 0, 0, 0, 180 }, panel, SDL_BLENDMODE_BLEND);
+
+    int y = panel.y + 8;
+    for (const FrameText& text : texts) {
+        queueText(LAYER_OVERLAY_TEXT, text, panel.x + 8, y);
+        y += lineHeight;
+    }
+}
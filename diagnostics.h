@@ -0,0 +1,14 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <SDL.h>
+
+// Developer overlay with runtime measurements, toggled with F3.
+void toggleDiagnostics();
+
+bool diagnosticsVisible();
+
+// Queues the overlay on top of the current frame if it is visible.
+void drawDiagnostics(SDL_Renderer* renderer);
+
+#endif // DIAGNOSTICS_H
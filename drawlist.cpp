@@ -0,0 +1,357 @@
+#include "drawlist.h"
+#include "globals.h"
+#include "log.h"
+#include "quality.h"
+#include "softrender.h"
+#include "textures.h"
+#include "tilebatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for one frame's commands. Chunks are kept across frames,
+// so once the busiest frame has been seen nothing more is allocated.
+class FrameArena {
+public:
+    void* allocate(size_t bytes)
+    {
+        const size_t align = alignof(std::max_align_t);
+        bytes = (bytes + align - 1) & ~(align - 1);
+        if (current < chunks.size() && used + bytes > CHUNK_BYTES) {
+            current++;
+            used = 0;
+        }
+        if (current == chunks.size())
+            chunks.emplace_back(new char[CHUNK_BYTES]);
+        void* p = chunks[current].get() + used;
+        used += bytes;
+        return p;
+    }
+
+    void reset()
+    {
+        current = 0;
+        used = 0;
+    }
+
+private:
+    static const size_t CHUNK_BYTES = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t current = 0;
+    size_t used = 0;
+};
+
+enum DrawKind {
+    DRAW_COPY,
+    DRAW_SCALED,
+    DRAW_FILL,
+    DRAW_OUTLINE
+};
+
+struct DrawCommand {
+    DrawLayer layer;
+    DrawKind kind;
+    SDL_Texture* texture;
+    SDL_BlendMode blend;
+    SDL_Color color;
+    bool hasSrc;
+    bool hasClip;
+    SDL_Rect src;
+    SDL_Rect dest;
+    SDL_Rect clip;
+    Uint32 sequence;    // Recorded order, the last sort key.
+};
+
+static FrameArena arena;
+static std::vector<DrawCommand*> commands;
+static std::vector<SDL_Texture*> frameTextures;
+static std::vector<SDL_Rect> rects;
+static SDL_Color clearColor = { 0, 0, 0, 255 };
+static int lastCommands = 0;
+static int lastCalls = 0;
+
+static bool hasScaledRegion = false;
+static SDL_Rect scaledRegion;
+static SDL_Texture* lowResTarget = nullptr;
+static int lowResW = 0;
+static int lowResH = 0;
+// Maps window coordinates onto the target being drawn: the identity, or the
+// scaled region onto the low resolution target.
+static float drawScale = 1.0f;
+static int drawOffsetX = 0;
+static int drawOffsetY = 0;
+
+static DrawCommand& record(DrawLayer layer, DrawKind kind, SDL_Texture* texture, const SDL_Rect& dest)
+{
+    DrawCommand* c = (DrawCommand*)arena.allocate(sizeof(DrawCommand));
+    *c = DrawCommand();
+    c->layer = layer;
+    c->kind = kind;
+    c->texture = texture;
+    c->blend = SDL_BLENDMODE_NONE;
+    c->dest = dest;
+    c->sequence = (Uint32)commands.size();
+    commands.push_back(c);
+    return *c;
+}
+
+void queueClear(SDL_Color color)
+{
+    clearColor = color;
+}
+
+void queueCopy(DrawLayer layer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect& dest)
+{
+    if (!texture)
+        return;
+    DrawCommand& c = record(layer, DRAW_COPY, texture, dest);
+    if (src) {
+        c.hasSrc = true;
+        c.src = *src;
+    }
+}
+
+void queueScaled(DrawLayer layer, SDL_Texture* texture, const SDL_Rect& dest, const SDL_Rect* clip)
+{
+    if (!texture)
+        return;
+    DrawCommand& c = record(layer, DRAW_SCALED, texture, dest);
+    if (clip) {
+        c.hasClip = true;
+        c.clip = *clip;
+    }
+}
+
+void queueFill(DrawLayer layer, SDL_Color color, const SDL_Rect& rect, SDL_BlendMode blend)
+{
+    DrawCommand& c = record(layer, DRAW_FILL, nullptr, rect);
+    c.color = color;
+    c.blend = blend;
+}
+
+void queueOutline(DrawLayer layer, SDL_Color color, const SDL_Rect& rect)
+{
+    record(layer, DRAW_OUTLINE, nullptr, rect).color = color;
+}
+
+FrameText frameText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color,
+                    bool blended, Uint32 wrap)
+{
+    FrameText out = { nullptr, 0, 0 };
+    if (!font || !text || !*text)
+        return out;
+    SDL_Surface* surface = wrap ? TTF_RenderText_Blended_Wrapped(font, text, color, wrap)
+                         : blended ? TTF_RenderText_Blended(font, text, color)
+                         : TTF_RenderText_Solid(font, text, color);
+    if (!surface)
+        return out;
+    out.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    out.w = surface->w;
+    out.h = surface->h;
+    SDL_FreeSurface(surface);
+    if (out.texture)
+        frameTextures.push_back(out.texture);
+    return out;
+}
+
+void queueText(DrawLayer layer, const FrameText& text, int x, int y)
+{
+    SDL_Rect dest = { x, y, text.w, text.h };
+    queueCopy(layer, text.texture, nullptr, dest);
+}
+
+void setScaledRegion(const SDL_Rect& region)
+{
+    hasScaledRegion = true;
+    scaledRegion = region;
+}
+
+void freeDrawListTargets()
+{
+    if (lowResTarget) {
+        SDL_DestroyTexture(lowResTarget);
+        untrackTextureBytes(TEXTURE_BACKGROUND, (size_t)lowResW * lowResH * 4);
+    }
+    lowResTarget = nullptr;
+    lowResW = 0;
+    lowResH = 0;
+}
+
+// Edges are mapped rather than sizes, so neighbouring tiles stay flush.
+static SDL_Rect mapRect(const SDL_Rect& r)
+{
+    int x0 = (int)std::floor((r.x - drawOffsetX) * drawScale);
+    int y0 = (int)std::floor((r.y - drawOffsetY) * drawScale);
+    int x1 = (int)std::floor((r.x + r.w - drawOffsetX) * drawScale);
+    int y1 = (int)std::floor((r.y + r.h - drawOffsetY) * drawScale);
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+// The target is kept between frames and only remade when its size changes.
+// A failed create is not retried until the size changes again.
+static bool prepareLowResTarget(SDL_Renderer* renderer, int w, int h)
+{
+    if (w == lowResW && h == lowResH)
+        return lowResTarget != nullptr;
+    freeDrawListTargets();
+    lowResW = w;
+    lowResH = h;
+    lowResTarget = SDL_CreateTexture(renderer, SDL_GetWindowPixelFormat(window), SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!lowResTarget) {
+        LOG_WARN(LOG_RENDER, "Could not create a %dx%d target, drawing at full resolution: %s", w, h, SDL_GetError());
+        return false;
+    }
+    trackTextureBytes(TEXTURE_BACKGROUND, (size_t)w * h * 4);
+    SDL_SetTextureBlendMode(lowResTarget, SDL_BLENDMODE_NONE);
+    SDL_SetTextureScaleMode(lowResTarget, SDL_ScaleModeLinear);
+    return true;
+}
+
+static void clearTarget(SDL_Renderer* renderer)
+{
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    SDL_RenderClear(renderer);
+}
+
+// Back to the window, with the low resolution picture stretched over the region.
+static void finishLowRes(SDL_Renderer* renderer)
+{
+    SDL_SetRenderTarget(renderer, nullptr);
+    drawScale = 1.0f;
+    drawOffsetX = 0;
+    drawOffsetY = 0;
+    SDL_Rect src = { 0, 0, lowResW, lowResH };
+    SDL_RenderCopy(renderer, lowResTarget, &src, &scaledRegion);
+}
+
+static bool drawsBefore(const DrawCommand* a, const DrawCommand* b)
+{
+    if (a->layer != b->layer)
+        return a->layer < b->layer;
+    if (a->texture != b->texture)
+        return std::less<SDL_Texture*>()(a->texture, b->texture);
+    if (a->blend != b->blend)
+        return a->blend < b->blend;
+    return a->sequence < b->sequence;
+}
+
+static bool sameRect(const SDL_Rect& a, const SDL_Rect& b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+static bool sameBatch(const DrawCommand& a, const DrawCommand& b)
+{
+    return a.layer == b.layer && a.kind == b.kind && a.texture == b.texture && a.blend == b.blend
+        && a.color.r == b.color.r && a.color.g == b.color.g && a.color.b == b.color.b && a.color.a == b.color.a
+        && a.hasClip == b.hasClip && (!a.hasClip || sameRect(a.clip, b.clip));
+}
+
+void submitDrawList(SDL_Renderer* renderer)
+{
+    std::sort(commands.begin(), commands.end(), drawsBefore);
+
+    // Everything under the panels in the scaled region goes to a smaller
+    // target first when the quality controller asks for it.
+    bool lowRes = false;
+    float scale = hasScaledRegion ? renderScale() : 1.0f;
+    if (scale < 1.0f) {
+        lowRes = prepareLowResTarget(renderer, SDL_max(1, (int)(scaledRegion.w * scale)),
+                                     SDL_max(1, (int)(scaledRegion.h * scale)));
+    }
+
+    clearTarget(renderer);
+    int calls = 1;
+    if (lowRes) {
+        SDL_SetRenderTarget(renderer, lowResTarget);
+        clearTarget(renderer);
+        calls++;
+        drawScale = scale;
+        drawOffsetX = scaledRegion.x;
+        drawOffsetY = scaledRegion.y;
+    }
+
+    bool clipped = false;
+    size_t i = 0;
+    while (i < commands.size()) {
+        const DrawCommand& first = *commands[i];
+        if (lowRes && first.layer >= LAYER_PANEL) {
+            if (clipped)
+                SDL_RenderSetClipRect(renderer, nullptr);
+            clipped = false;
+            finishLowRes(renderer);
+            lowRes = false;
+            calls++;
+        }
+        size_t end = i + 1;
+        while (end < commands.size() && sameBatch(first, *commands[end])) {
+            end++;
+        }
+        if (first.hasClip || clipped) {
+            SDL_Rect clip = mapRect(first.clip);
+            SDL_RenderSetClipRect(renderer, first.hasClip ? &clip : nullptr);
+            clipped = first.hasClip;
+        }
+
+        switch (first.kind) {
+            case DRAW_FILL:
+            case DRAW_OUTLINE:
+                rects.clear();
+                for (size_t k = i; k < end; k++) {
+                    rects.push_back(mapRect(commands[k]->dest));
+                }
+                SDL_SetRenderDrawBlendMode(renderer, first.blend);
+                SDL_SetRenderDrawColor(renderer, first.color.r, first.color.g, first.color.b, first.color.a);
+                if (first.kind == DRAW_FILL)
+                    SDL_RenderFillRects(renderer, rects.data(), (int)rects.size());
+                else
+                    SDL_RenderDrawRects(renderer, rects.data(), (int)rects.size());
+                calls++;
+                break;
+            case DRAW_SCALED:
+                for (size_t k = i; k < end; k++) {
+                    batchTile(first.texture, mapRect(commands[k]->dest));
+                }
+                flushTileBatch(renderer);
+                calls += softwareRendering() ? (int)(end - i) : 1;
+                break;
+            case DRAW_COPY:
+                for (size_t k = i; k < end; k++) {
+                    const DrawCommand& c = *commands[k];
+                    SDL_Rect dest = mapRect(c.dest);
+                    SDL_RenderCopy(renderer, c.texture, c.hasSrc ? &c.src : nullptr, &dest);
+                }
+                calls += (int)(end - i);
+                break;
+        }
+        i = end;
+    }
+    if (clipped)
+        SDL_RenderSetClipRect(renderer, nullptr);
+    if (lowRes) {
+        finishLowRes(renderer);
+        calls++;
+    }
+    // Queued SDL commands run now, so the frame timing sees their cost.
+    SDL_RenderFlush(renderer);
+
+    for (SDL_Texture* texture : frameTextures) {
+        SDL_DestroyTexture(texture);
+    }
+    frameTextures.clear();
+    lastCommands = (int)commands.size();
+    lastCalls = calls;
+    commands.clear();
+    arena.reset();
+    clearColor = { 0, 0, 0, 255 };
+    hasScaledRegion = false;
+}
+
+void drawListStats(int* commandCount, int* calls)
+{
+    *commandCount = lastCommands;
+    *calls = lastCalls;
+}
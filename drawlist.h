@@ -0,0 +1,77 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+// The frame's draw commands. Screens record what they draw instead of
+// calling SDL directly; submitDrawList() then sorts the commands by layer,
+// texture and blend mode and sends them to SDL in batches: runs of fills
+// become one SDL_RenderFillRects call and runs of the same scaled texture one
+// geometry call. Commands live in an arena that is emptied every frame.
+//
+// Within a layer only commands with the same texture and blend mode keep
+// their recorded order, so things that overlap go on different layers.
+
+enum DrawLayer {
+    LAYER_BACKGROUND,   // Full-window art.
+    LAYER_BOARD_BACK,   // Behind the tiles.
+    LAYER_BOARD,        // Tiles.
+    LAYER_BOARD_FRONT,  // Over the tiles.
+    LAYER_BOARD_TEXT,   // Values written on tiles.
+    LAYER_PANEL,        // The sidebar and text pages.
+    LAYER_DECOR,        // Pictures and boxes laid on a panel.
+    LAYER_CONTROL,      // Buttons, icons, bars and slider tracks.
+    LAYER_CONTROL_TOP,  // Slider knobs.
+    LAYER_TEXT,         // Labels.
+    LAYER_OVERLAY,      // The diagnostics panel.
+    LAYER_OVERLAY_TEXT,
+    LAYER_COUNT
+};
+
+// The window is cleared to this color before anything is drawn.
+void queueClear(SDL_Color color);
+
+// A texture (or part of it, when src is set) at dest.
+void queueCopy(DrawLayer layer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect& dest);
+
+// A whole texture stretched to dest, as drawScaled() draws it; these are
+// the commands that batch. clip, when set, limits it to a rectangle.
+void queueScaled(DrawLayer layer, SDL_Texture* texture, const SDL_Rect& dest, const SDL_Rect* clip = nullptr);
+
+void queueFill(DrawLayer layer, SDL_Color color, const SDL_Rect& rect,
+               SDL_BlendMode blend = SDL_BLENDMODE_NONE);
+
+void queueOutline(DrawLayer layer, SDL_Color color, const SDL_Rect& rect);
+
+// A line of text rasterized for this frame only; the texture is destroyed
+// after the submit. texture is nullptr if the text could not be rendered.
+struct FrameText {
+    SDL_Texture* texture;
+    int w;
+    int h;
+};
+
+// TTF_RenderText_Solid, or _Blended when blended is set, or _Blended_Wrapped
+// when wrap is non-zero.
+FrameText frameText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color,
+                    bool blended = false, Uint32 wrap = 0);
+
+// Queues frame text with its top left at (x, y).
+void queueText(DrawLayer layer, const FrameText& text, int x, int y);
+
+// Layers under LAYER_PANEL inside region may be drawn at the dynamic
+// resolution scale (see quality.h) and stretched back over it. Screens with
+// a costly game area set it each frame; the submit clears it.
+void setScaledRegion(const SDL_Rect& region);
+
+// Drops the offscreen target the scaled region is drawn to.
+void freeDrawListTargets();
+
+// Draws the frame's commands and empties the list; the caller presents.
+void submitDrawList(SDL_Renderer* renderer);
+
+// Commands and SDL draw calls in the last submitted frame.
+void drawListStats(int* commands, int* calls);
+
+#endif // DRAWLIST_H
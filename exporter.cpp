@@ -0,0 +1,234 @@
+#include "exporter.h"
+#include "assets.h"
+#include "game.h"
+#include "globals.h"
+#include "graphics.h"
+#include "log.h"
+#include "replay.h"
+#include "screens.h"
+#include "softrender.h"
+#include "textures.h"
+#include "timers.h"
+#include "video.h"
+
+// A frame on its way through the pipeline: rendered by the main thread,
+// converted by a worker, then written in order by the main thread again.
+enum SlotState {
+    SLOT_FREE,
+    SLOT_RENDERED,
+    SLOT_CONVERTING,
+    SLOT_CONVERTED
+};
+
+struct ExportSlot {
+    std::vector<Uint8> pixels;  // ARGB8888.
+    std::vector<Uint8> planes;
+    Uint32 repeats;             // Video frames this picture fills.
+    SlotState state;
+};
+
+static std::vector<ExportSlot> slots;
+static SDL_mutex* slotMutex = nullptr;
+static SDL_cond* slotChanged = nullptr;
+static bool workersStopping = false;
+static int downscale = 1;
+// Frames handed to the workers and frames written, counted over one video.
+static Uint32 framesRendered = 0;
+static Uint32 framesWritten = 0;
+
+static int exportWorker(void*)
+{
+    SDL_LockMutex(slotMutex);
+    while (true) {
+        ExportSlot* job = nullptr;
+        for (ExportSlot& s : slots) {
+            if (s.state == SLOT_RENDERED) {
+                job = &s;
+                break;
+            }
+        }
+        if (!job) {
+            if (workersStopping)
+                break;
+            SDL_CondWait(slotChanged, slotMutex);
+            continue;
+        }
+        job->state = SLOT_CONVERTING;
+        SDL_UnlockMutex(slotMutex);
+        convertFrame(job->pixels.data(), EXPORT_WIDTH * 4, EXPORT_WIDTH, EXPORT_HEIGHT, downscale,
+                     job->planes.data());
+        SDL_LockMutex(slotMutex);
+        job->state = SLOT_CONVERTED;
+        SDL_CondBroadcast(slotChanged);
+    }
+    SDL_UnlockMutex(slotMutex);
+    return 0;
+}
+
+// Writes finished frames in order until no more than outstanding are left
+// in flight, waiting on the workers where it must.
+static bool writeFrames(Y4mFile& video, Uint32 outstanding)
+{
+    bool ok = true;
+    SDL_LockMutex(slotMutex);
+    while (framesRendered - framesWritten > outstanding) {
+        ExportSlot& s = slots[framesWritten % slots.size()];
+        while (s.state != SLOT_CONVERTED) {
+            SDL_CondWait(slotChanged, slotMutex);
+        }
+        SDL_UnlockMutex(slotMutex);
+        for (Uint32 n = 0; n < s.repeats && ok; n++) {
+            ok = writeY4mFrame(video, s.planes.data());
+        }
+        SDL_LockMutex(slotMutex);
+        s.state = SLOT_FREE;
+        framesWritten++;
+    }
+    SDL_UnlockMutex(slotMutex);
+    return ok;
+}
+
+static bool renderFrame(SDL_Renderer* renderer, Y4mFile& video, Uint32 repeats)
+{
+    // The slot this frame takes must have been written out.
+    if (!writeFrames(video, (Uint32)slots.size() - 1))
+        return false;
+    ExportSlot& s = slots[framesRendered % slots.size()];
+    renderScreen(renderer);
+    if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, s.pixels.data(), EXPORT_WIDTH * 4) != 0) {
+        LOG_ERROR(LOG_RENDER, "Cannot read back an export frame: %s", SDL_GetError());
+        return false;
+    }
+    SDL_LockMutex(slotMutex);
+    s.repeats = repeats;
+    s.state = SLOT_RENDERED;
+    framesRendered++;
+    SDL_CondBroadcast(slotChanged);
+    SDL_UnlockMutex(slotMutex);
+    return true;
+}
+
+// Screens start their timers on entry; the export keeps them still so the
+// booster bars hold their time.
+static void showScreen(UiScreen screen)
+{
+    changeScreen(screen);
+    pauseTimers();
+}
+
+static bool exportReplay(SDL_Window* window, SDL_Renderer* renderer, const std::string& path)
+{
+    Replay replay;
+    if (!loadReplay(path, replay))
+        return false;
+    Uint32 startTicks = SDL_GetTicks();
+
+    GRID_SIZE = replay.gridSize;
+    recomputeLayout(window);
+    deal_board(replay.seed);
+    incrementscore = 0;
+    lock2048 = false;
+    // The end screens show art picked by the deal; it has to be resident.
+    if (gameoverTextures.count(currentGameoverIndex))
+        prefetchTexture(gameoverTextures[currentGameoverIndex]);
+    if (gamewinTextures.count(currentWinIndex))
+        prefetchTexture(gamewinTextures[currentWinIndex]);
+    while (assetsPending()) {
+        pumpAssetLoader(renderer, 10);
+    }
+
+    std::string videoPath = path.substr(0, path.find_last_of('.')) + ".y4m";
+    Y4mFile video;
+    if (!openY4m(video, videoPath.c_str(), downscaledSize(EXPORT_WIDTH, downscale),
+                 downscaledSize(EXPORT_HEIGHT, downscale), EXPORT_FPS))
+        return false;
+    framesRendered = 0;
+    framesWritten = 0;
+
+    showScreen(UI_SCREEN_GAME);
+    bool ok = renderFrame(renderer, video, EXPORT_HOLD_FRAMES);
+    for (size_t n = 0; n < replay.actions.size() && ok; n++) {
+        applyReplayAction(replay.actions[n]);
+        ok = renderFrame(renderer, video, EXPORT_ACTION_FRAMES);
+        // Play only went on past a win through the win screen's Continue.
+        if (ok && is_game_won() && !lock2048) {
+            showScreen(UI_SCREEN_WIN);
+            ok = renderFrame(renderer, video, EXPORT_HOLD_FRAMES);
+            lock2048 = true;
+            showScreen(UI_SCREEN_GAME);
+        }
+    }
+    if (ok && is_game_over()) {
+        showScreen(UI_SCREEN_GAMEOVER);
+        ok = renderFrame(renderer, video, EXPORT_HOLD_FRAMES);
+    }
+    ok = writeFrames(video, 0) && ok;
+    closeY4m(video);
+    if (!ok) {
+        LOG_ERROR(LOG_RENDER, "Exporting %s to %s failed.", path.c_str(), videoPath.c_str());
+        return false;
+    }
+
+    if (score != replay.score)
+        LOG_WARN(LOG_RENDER, "%s replays to a score of %d but was recorded with %d.", path.c_str(), score, replay.score);
+    Uint32 elapsed = SDL_max(1u, SDL_GetTicks() - startTicks);
+    LOG_INFO(LOG_RENDER, "Exported %s: %u actions, %u frames in %u ms, %.1fx real time.", videoPath.c_str(),
+             (unsigned)replay.actions.size(), video.frames, elapsed, video.frames * 1000.0 / EXPORT_FPS / elapsed);
+    return true;
+}
+
+bool runReplayExport(SDL_Window* window, SDL_Renderer* renderer, const std::vector<std::string>& replays,
+                     int downscaleFactor)
+{
+    setSoftwarePacing(false);
+    SDL_SetWindowSize(window, EXPORT_WIDTH, EXPORT_HEIGHT);
+    SDL_PumpEvents();
+    prefetchTexture(recordBackground);
+
+    // The main thread renders; every other core converts.
+    downscale = SDL_max(1, downscaleFactor);
+    int workerCount = SDL_max(1, SDL_GetCPUCount() - 1);
+    slots.assign((size_t)workerCount * 2 + 2, ExportSlot());
+    for (ExportSlot& s : slots) {
+        s.pixels.resize((size_t)EXPORT_WIDTH * EXPORT_HEIGHT * 4);
+        s.planes.resize(y4mFrameBytes(downscaledSize(EXPORT_WIDTH, downscale), downscaledSize(EXPORT_HEIGHT, downscale)));
+        s.state = SLOT_FREE;
+    }
+    slotMutex = SDL_CreateMutex();
+    slotChanged = SDL_CreateCond();
+    workersStopping = false;
+    std::vector<SDL_Thread*> workers;
+    for (int n = 0; n < workerCount; n++) {
+        SDL_Thread* thread = SDL_CreateThread(exportWorker, "ExportWorker", nullptr);
+        if (thread)
+            workers.push_back(thread);
+    }
+
+    int failures = 0;
+    if (workers.empty()) {
+        LOG_ERROR(LOG_RENDER, "Failed to start export workers: %s", SDL_GetError());
+        failures = (int)replays.size();
+    } else {
+        for (const std::string& path : replays) {
+            if (!exportReplay(window, renderer, path))
+                failures++;
+        }
+    }
+
+    SDL_LockMutex(slotMutex);
+    workersStopping = true;
+    SDL_CondBroadcast(slotChanged);
+    SDL_UnlockMutex(slotMutex);
+    for (SDL_Thread* thread : workers) {
+        SDL_WaitThread(thread, nullptr);
+    }
+    SDL_DestroyCond(slotChanged);
+    SDL_DestroyMutex(slotMutex);
+    slotChanged = nullptr;
+    slotMutex = nullptr;
+    std::vector<ExportSlot>().swap(slots);
+
+    changeScreen(UI_SCREEN_START);
+    LOG_INFO(LOG_RENDER, "Replay export: %d of %d videos written.", (int)replays.size() - failures, (int)replays.size());
+    return failures == 0;
+}
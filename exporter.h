@@ -0,0 +1,27 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+// Replay export (--export-replay=<file>, repeatable). Each replay is dealt
+// again from its seed and played action by action with the game rules; the
+// game screen is drawn after every action by the normal screen code and
+// written to <file>.y4m at EXPORT_FPS. Runs like golden mode, with the
+// software renderer on an offscreen window and no vsync or pacing, and
+// frames are converted to YUV on worker threads while the next one renders.
+
+const int EXPORT_WIDTH = 1920;
+const int EXPORT_HEIGHT = 1080;
+const int EXPORT_FPS = 30;
+// Video frames each action stays on screen, and the opening and end screens.
+const Uint32 EXPORT_ACTION_FRAMES = 8;
+const Uint32 EXPORT_HOLD_FRAMES = EXPORT_FPS * 3;
+
+// Exports every replay; frames are shrunk downscale times. Returns false if
+// any replay could not be read or written.
+bool runReplayExport(SDL_Window* window, SDL_Renderer* renderer, const std::vector<std::string>& replays,
+                     int downscale);
+
+#endif // EXPORTER_H
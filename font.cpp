@@ -1,28 +1,38 @@
 #include "globals.h"
 #include "font.h"
-#include <iostream>
+#include "pack.h"
+#include "log.h"
 #include <SDL_ttf.h>
 
+// Opens the font from the asset pack when there is one, else from disk.
+static TTF_Font* openFont(const char* path, int size)
+{
+    const PackEntry* entry = findPackEntry(assetId(path));
+    if (entry)
+        return TTF_OpenFontRW(packRW(entry), 1, size);
+    return TTF_OpenFont(path, size);
+}
+
 bool initFont(){
-    titleFont   = TTF_OpenFont("assets/Font/doodle.ttf", 72);
+    titleFont   = openFont("assets/Font/doodle.ttf", 72);
     if (!titleFont){
-        std::cerr << "Failed to load title font: " << TTF_GetError() << "\n";
+        LOG_ERROR(LOG_ASSETS, "Failed to load title font: %s", TTF_GetError());
     }
-    smallFont   = TTF_OpenFont("assets/Font/doodle.ttf", 42);
+    smallFont   = openFont("assets/Font/doodle.ttf", 42);
     if (!smallFont){
-        std::cerr << "Failed to load small font: " << TTF_GetError() << "\n";
+        LOG_ERROR(LOG_ASSETS, "Failed to load small font: %s", TTF_GetError());
     }
-    buttonFont  = TTF_OpenFont("assets/Font/doodle.ttf", 36);
+    buttonFont  = openFont("assets/Font/doodle.ttf", 36);
     if (!buttonFont){
-        std::cerr << "Failed to load button font: " << TTF_GetError() << "\n";
+        LOG_ERROR(LOG_ASSETS, "Failed to load button font: %s", TTF_GetError());
     }
-    boosterFont  = TTF_OpenFont("assets/Font/doodle.ttf", 28);
+    boosterFont  = openFont("assets/Font/doodle.ttf", 28);
     if (!boosterFont){
-        std::cerr << "Failed to load booster font: " << TTF_GetError() << "\n";
+        LOG_ERROR(LOG_ASSETS, "Failed to load booster font: %s", TTF_GetError());
     }
-    valueFont  = TTF_OpenFont("assets/Font/doodle.ttf", 20);
+    valueFont  = openFont("assets/Font/doodle.ttf", 20);
     if (!valueFont){
-        std::cerr << "Failed to load value font: " << TTF_GetError() << "\n";
+        LOG_ERROR(LOG_ASSETS, "Failed to load value font: %s", TTF_GetError());
     }
     return true;
 }
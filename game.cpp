@@ -2,13 +2,42 @@
 #include "globals.h"
 #include "audio.h"
 #include "boosters.h"
-#include <iostream>
+#include "history.h"
+#include "persistence.h"
+#include "replay.h"
+#include "screens.h"
+#include "session.h"
+#include "textures.h"
+#include "timers.h"
+#include "log.h"
 #include <fstream>
-#include <cstdlib>
 #include <ctime>
 #include <map>
 
-void add_random_tile() {
+static Uint64 randomState = 1;
+
+// splitmix64 spreads the seed over the state, so neighbouring seeds (one
+// second apart) still start far apart.
+void seedGameRandom(Uint32 seed)
+{
+    Uint64 z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    randomState = z ? z : 1;
+}
+
+// xorshift64*, scaled to the bound by a multiply rather than a modulo.
+Uint32 gameRandom(Uint32 bound)
+{
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    Uint32 r = (Uint32)((randomState * 0x2545F4914F6CDD1Dull) >> 32);
+    return (Uint32)(((Uint64)r * bound) >> 32);
+}
+
+int add_random_tile() {
     int empty_cells = 0;
     for (int i = 0; i < GRID_SIZE; i++) {
         for (int j = 0; j < GRID_SIZE; j++) {
@@ -17,20 +46,21 @@ void add_random_tile() {
         }
     }
     if (empty_cells == 0)
-        return;
-    int target = rand() % empty_cells;
-    int value = (rand() % 10 == 0) ? 4 : 2;
+        return -1;
+    int target = (int)gameRandom(empty_cells);
+    int value = gameRandom(10) == 0 ? 4 : 2;
     for (int i = 0; i < GRID_SIZE; i++) {
         for (int j = 0; j < GRID_SIZE; j++) {
             if (grid[i][j] == 0 && target-- == 0) {
                 grid[i][j] = value;
-                return;
+                return i * GRID_SIZE + j;
             }
         }
     }
+    return -1;
 }
 
-void add_random_blocker() {
+static int add_random_blocker() {
     int emptyCells = 0;
     for (int i = 0; i < GRID_SIZE; i++) {
         for (int j = 0; j < GRID_SIZE; j++) {
@@ -40,26 +70,82 @@ void add_random_blocker() {
         }
     }
     if (emptyCells == 0) {
-        return;
+        return -1;
     }
     if (freezeActive){
         emptyCells = 1e7;
     }
-    int target = rand() % (emptyCells + 10);
+    int target = (int)gameRandom(emptyCells + 10);
     for (int i = 0; i < GRID_SIZE; i++) {
         for (int j = 0; j < GRID_SIZE; j++) {
             if (grid[i][j] == 0 && target-- == 0) {
                 grid[i][j] = BLOCKER_VALUE;
-                return;
+                return i * GRID_SIZE + j;
             }
         }
     }
+    return -1;
+}
+
+
+// Starts loading the art and music of whichever end screen or toast the board
+// is heading for, so it is resident by the time it appears.
+static void prefetchUpcomingScreens()
+{
+    int empty = 0;
+    int maxTile = 0;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            if (grid[i][j] == 0)
+                empty++;
+            if (grid[i][j] > maxTile)
+                maxTile = grid[i][j];
+        }
+    }
+    emptyCells = empty;
+
+    if (empty <= 2 && gameoverTextures.count(currentGameoverIndex)) {
+        prefetchTexture(gameoverTextures[currentGameoverIndex]);
+    }
+    if (!lock2048 && maxTile >= 1024) {
+        if (gamewinTextures.count(currentWinIndex))
+            prefetchTexture(gamewinTextures[currentWinIndex]);
+        prefetchGameWinMusic();
+    }
+    // With no highscore yet there is no record to approach.
+    if (!congratsShown && highscore > 0 && score * 10 >= highscore * 9) {
+        prefetchTexture(recordBackground);
+        prefetchCongratsMusic();
+    }
 }
 
+int tileExponent(int value)
+{
+    int n = 0;
+    while (value > 1) {
+        value >>= 1;
+        n++;
+    }
+    return n;
+}
+
+Uint8 packCell(int value)
+{
+    if (value == BLOCKER_VALUE)
+        return PACKED_BLOCKER;
+    return value > 0 ? (Uint8)tileExponent(value) : 0;
+}
+
+int unpackCell(Uint8 cell)
+{
+    if (cell == PACKED_BLOCKER)
+        return BLOCKER_VALUE;
+    return cell == 0 ? 0 : 1 << cell;
+}
 
 void loadHighscore()
 {
-    std::ifstream infile("assets/text/highscore.txt");
+    std::ifstream infile(HIGHSCORE_PATH);
     if (infile.is_open()) {
         infile >> highscore;
     }
@@ -67,15 +153,24 @@ void loadHighscore()
 
 void saveHighscore()
 {
-    std::ofstream outfile("assets/text/highscore.txt");
-    if (outfile.is_open()) {
-        outfile << highscore;
-    }
+    queueHighscore(highscore);
 }
 
-void initialize_grid() {
-    std::cerr << "initialize_grid() start" << std::endl;
-    srand((unsigned)time(nullptr));
+void boosterExpired()
+{
+    boosterActive = false;
+    journalAction(JOURNAL_BOOSTER_EXPIRED);
+    LOG_DEBUG(LOG_BOOSTER, "Booster expired.");
+}
+
+void hideHighscoreToast()
+{
+    newHighscoreAchieved = false;
+}
+
+void deal_board(unsigned seed)
+{
+    seedGameRandom(seed);
     score = 0;
     newHighscoreAchieved = false;
     boosterActive = false;
@@ -83,22 +178,34 @@ void initialize_grid() {
     freezeActive = false;
     tsunamiActive = false;
     currentBooster = {100, 0};
-    boosterStartTime = 0;
+    cancelTimer(TIMER_BOOSTER);
+    cancelTimer(TIMER_FREEZE);
+    cancelTimer(TIMER_HIGHSCORE_TOAST);
     for (const auto &pair : boosterSettings) {
         boosterActivated[pair.first] = false;
     }
     newHighscoreAchieved = false;
+    // Pick the end screen art up front so it can be prefetched as the end nears.
+    currentGameoverIndex = gameoverTextures.empty() ? 0 : (int)gameRandom((Uint32)gameoverTextures.size()) + 1;
+    currentWinIndex = gamewinTextures.empty() ? 0 : (int)gameRandom((Uint32)gamewinTextures.size()) + 1;
     for (int i = 0; i < GRID_SIZE; i++) {
         for (int j = 0; j < GRID_SIZE; j++) {
             grid[i][j] = 0;
         }
     }
-    std::cerr << "Before add_random_tile()" << std::endl;
     add_random_tile();
-    std::cerr << "initialize_grid() end" << std::endl;
 }
 
-void move_tiles(SDL_Keycode key)
+void initialize_grid() {
+    unsigned seed = (unsigned)time(nullptr);
+    deal_board(seed);
+    historyBeginGame(seed);
+    replayBeginGame(seed);
+    sessionNewGame();
+    LOG_DEBUG(LOG_GAME, "New game dealt from seed %u.", seed);
+}
+
+bool slide_tiles(SDL_Keycode key)
 {
     incrementscore = 0;
     bool moved = false;
@@ -124,7 +231,7 @@ void move_tiles(SDL_Keycode key)
                                 if (boosterSettings.count(grid[k - 1][j]) && !boosterActivated[grid[k - 1][j]]) {
                                     currentBooster = boosterSettings[grid[k - 1][j]];
                                     boosterActive = true;
-                                    boosterStartTime = SDL_GetTicks();
+                                    scheduleTimer(TIMER_BOOSTER, currentBooster.duration, boosterExpired);
                                     boosterActivated[grid[k - 1][j]] = true;
                                 }
                                 if (boosterActive){
@@ -165,7 +272,7 @@ void move_tiles(SDL_Keycode key)
                                 if (boosterSettings.count(grid[k + 1][j]) && !boosterActivated[grid[k + 1][j]]) {
                                     currentBooster = boosterSettings[grid[k + 1][j]];
                                     boosterActive = true;
-                                    boosterStartTime = SDL_GetTicks();
+                                    scheduleTimer(TIMER_BOOSTER, currentBooster.duration, boosterExpired);
                                     boosterActivated[grid[k + 1][j]] = true;
                                 }
                                 if (boosterActive){
@@ -206,7 +313,7 @@ void move_tiles(SDL_Keycode key)
                                 if (boosterSettings.count(grid[i][k - 1]) && !boosterActivated[grid[i][k - 1]]) {
                                     currentBooster = boosterSettings[grid[i][k - 1]];
                                     boosterActive = true;
-                                    boosterStartTime = SDL_GetTicks();
+                                    scheduleTimer(TIMER_BOOSTER, currentBooster.duration, boosterExpired);
                                     boosterActivated[grid[i][k - 1]] = true;
                                 }
                                 if (boosterActive){
@@ -247,7 +354,7 @@ void move_tiles(SDL_Keycode key)
                                 if (boosterSettings.count(grid[i][k + 1]) && !boosterActivated[grid[i][k + 1]]) {
                                     currentBooster = boosterSettings[grid[i][k + 1]];
                                     boosterActive = true;
-                                    boosterStartTime = SDL_GetTicks();
+                                    scheduleTimer(TIMER_BOOSTER, currentBooster.duration, boosterExpired);
                                     boosterActivated[grid[i][k + 1]] = true;
                                 }
                                 if (boosterActive){
@@ -268,42 +375,60 @@ void move_tiles(SDL_Keycode key)
             }
             break;
     }
-    if (moved) {
-        Mix_PlayChannel(-1, swipeSound, 0);
-        add_random_tile();
-        if (rand() % 100 < 5) { // 20% chance
-            add_random_blocker();
-        }
+    return moved;
+}
+
+static void spawn_after_move(int* spawnCell, int* blockerCell)
+{
+    *spawnCell = add_random_tile();
+    *blockerCell = -1;
+    if (gameRandom(100) < 5) { // 20% chance
+        *blockerCell = add_random_blocker();
+    }
+}
+
+bool step_board(SDL_Keycode key)
+{
+    if (!slide_tiles(key))
+        return false;
+    int spawnCell, blockerCell;
+    spawn_after_move(&spawnCell, &blockerCell);
+    return true;
+}
+
+void move_tiles(SDL_Keycode key)
+{
+    if (slide_tiles(key)) {
+        playSwipeSFX();
+        prefetchUpcomingScreens();
+        int spawnCell, blockerCell;
+        spawn_after_move(&spawnCell, &blockerCell);
+        currentGameStats.values[HISTORY_MOVES]++;
+        if (blockerCell >= 0)
+            currentGameStats.values[HISTORY_BLOCKERS]++;
+        journalAction(JOURNAL_MOVE, key, spawnCell, blockerCell);
         if (score > highscore) {
             highscore = score;
             saveHighscore();
             if (!newHighscoreAchieved && !congratsShown) {
                 newHighscoreAchieved = true;
                 congratsShown = true;
-                newHighscoreTime = SDL_GetTicks();
-                if (congratsMusic) {
-                    Mix_HookMusicFinished(MusicFinishedCallback);
-                    Mix_PlayMusic(congratsMusic, 1);
-                }
+                scheduleTimer(TIMER_HIGHSCORE_TOAST, HIGHSCORE_TOAST_MS, hideHighscoreToast);
+                playCongratsMusic();
             }
         }
-        if (is_game_won() && !lock2048) {
-            if (!gameWon) {
-                int numTextures = gamewinTextures.size();
-                currentWinIndex = (rand() % numTextures) + 1;
-                gameWon = true;
-                Mix_PlayMusic(gameWinMusic, -1);
-            }
+        bool won = is_game_won() && !lock2048;
+        if (won) {
+            changeScreen(UI_SCREEN_WIN);
         }
         if (is_game_over()) {
-            if (!gameOver) {
-                Mix_HookMusicFinished(NULL);
-                Mix_HaltMusic();
-                int numTextures = gameoverTextures.size();
-                currentGameoverIndex = (rand() % numTextures) + 1;
-                gameOver = true;
-                Mix_PlayChannel(-1, gameOverSound, 0);
-            }
+            LOG_DEBUG(LOG_GAME, "Game over detected after move.");
+            sessionEnd();
+            historyFinishGame();
+            replayFinishGame();
+            // The win screen's Continue button leads here instead.
+            if (!won)
+                changeScreen(UI_SCREEN_GAMEOVER);
         }
     }
 }
@@ -3,10 +3,46 @@
 
 #include <SDL.h>
 
-void add_random_tile();
+// Places a 2 or 4 on a random empty cell. Returns the cell
+// (row * GRID_SIZE + col), or -1 if the board is full.
+int add_random_tile();
 
+// The game's own random numbers: the same sequence for a seed on every
+// platform and C library, so a replay recorded on one machine plays back
+// the same on another. gameRandom returns a value in [0, bound).
+void seedGameRandom(Uint32 seed);
+Uint32 gameRandom(Uint32 bound);
+
+// Resets the game state and deals the first tile from seed. Everything
+// random in a game after this comes from the gameRandom() sequence.
+void deal_board(unsigned seed);
+
+// deal_board from the clock, starting the game's history, replay and save.
 void initialize_grid();
 
+// log2 of a tile value: 2 -> 1, 2048 -> 11. Boards are stored as these byte
+// exponents where size matters.
+int tileExponent(int value);
+
+// A cell as one byte: 0 when empty, PACKED_BLOCKER for a blocker, otherwise
+// the tile exponent.
+const Uint8 PACKED_BLOCKER = 0xFF;
+Uint8 packCell(int value);
+int unpackCell(Uint8 cell);
+
+// Timer callbacks for the score multiplier and the "New Record!" panel.
+void boosterExpired();
+void hideHighscoreToast();
+
+// Slides and merges the board for an arrow key and updates score and
+// boosters. No tiles are spawned and nothing is played; returns whether
+// anything moved.
+bool slide_tiles(SDL_Keycode key);
+
+// slide_tiles followed by the spawns of a move: a new tile and, now and then,
+// a blocker. Silent and unjournaled, for boards other than the main game.
+bool step_board(SDL_Keycode key);
+
 void move_tiles(SDL_Keycode key);
 
 bool is_game_over();
@@ -15,6 +51,7 @@ bool is_game_won();
 
 void loadHighscore();
 
+// Hands the current highscore to the persistence thread; see persistence.h.
 void saveHighscore();
 
 #endif // GAME_H
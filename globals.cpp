@@ -1,7 +1,7 @@
 // globals.cpp
 #include "globals.h"
 
-int GRID_SIZE = 4;
+int GRID_SIZE = CLASSIC_GRID_SIZE;
 int GAME_AREA_WIDTH = 0;
 int SIDEBAR_WIDTH = 0;
 int WINDOW_WIDTH = 0;
@@ -11,14 +11,8 @@ int TILE_SIZE = 0;
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
 
-int grid[4][4] = {0};
-bool gameStarted = false;
-bool gameOver = false;
-bool gameWon = false;
+int grid[MAX_GRID_SIZE][MAX_GRID_SIZE] = {{0}};
 bool lock2048 = false;
-bool showHelp = false;
-bool showOptions = false;
-bool showCredits = false;
 bool newHighscoreAchieved = false;
 bool isFullscreen = false;
 bool musicSliderActive = false;
@@ -27,7 +21,6 @@ bool quit = false;
 bool congratsShown = false;
 
 bool boosterActive = false;
-Uint32 boosterStartTime = 0;
 const Uint32 BOOSTER_DURATION = 10000;
 std::map<int, bool> boosterActivated;
 Booster currentBooster = {100, 0};
@@ -45,8 +38,6 @@ std::map<int, Booster> boosterSettings = {
     { 2048, {210, 10000} },
 };
 
-Uint32 newHighscoreTime = 0;
-
 const int DEFAULT_VOLUME = 100;
 const int DEFAULT_SFX_VOLUME = 100;
 int musicVolume = DEFAULT_VOLUME;
@@ -55,16 +46,13 @@ int sfxVolume = DEFAULT_SFX_VOLUME;
 int incrementscore = 0;
 int score = 0;
 int highscore = 0;
-int helpScrollOffset = 0;
+float helpScrollOffset = 0.0f;
+float helpScrollVelocity = 0.0f;
 int emptyCells = 0;
 
 int currentGameoverIndex = 0;
 int currentWinIndex = 0;
 
-Mix_Music* bgMusic = nullptr;
-Mix_Music* congratsMusic = nullptr;
-Mix_Music* gameWinMusic = nullptr;
-
 Mix_Chunk* swipeSound = nullptr;
 Mix_Chunk* gameOverSound = nullptr;
 
@@ -73,7 +61,7 @@ SDL_Texture* optionBackground = nullptr;
 SDL_Texture* startBackground = nullptr;
 SDL_Texture* sidebarBackground = nullptr;
 SDL_Texture* scoreBackground = nullptr;
-SDL_Texture* recordBackground = nullptr;
+LazyTexture* recordBackground = nullptr;
 SDL_Texture* gameoverBackground = nullptr;
 SDL_Texture* gamewonBackground = nullptr;
 SDL_Texture* blockerTexture = nullptr;
@@ -91,8 +79,8 @@ TTF_Font* boosterFont = nullptr;
 TTF_Font* valueFont   = nullptr;
 
 std::map<int, SDL_Texture*> fruitTextures;
-std::map<int, SDL_Texture*> gamewinTextures;
-std::map<int, SDL_Texture*> gameoverTextures;
+std::map<int, LazyTexture*> gamewinTextures;
+std::map<int, LazyTexture*> gameoverTextures;
 
 
 
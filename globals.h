@@ -7,6 +7,12 @@
 #include <SDL_ttf.h>
 #include <map>
 
+struct LazyTexture;
+
+// Board sizes. GRID_SIZE is the one in play, up to MAX_GRID_SIZE.
+const int CLASSIC_GRID_SIZE = 4;
+const int MAX_GRID_SIZE = 32;
+
 // Layout variables.
 extern int GRID_SIZE;
 extern int GAME_AREA_WIDTH;
@@ -19,14 +25,8 @@ extern SDL_Window* window;
 extern SDL_Renderer* renderer;
 
 // Game state.
-extern int grid[4][4];
-extern bool gameStarted;
-extern bool gameOver;
-extern bool gameWon;
+extern int grid[MAX_GRID_SIZE][MAX_GRID_SIZE];
 extern bool lock2048;
-extern bool showHelp;
-extern bool showOptions;
-extern bool showCredits;
 extern bool newHighscoreAchieved;
 extern bool isFullscreen;
 extern bool musicSliderActive;
@@ -37,7 +37,6 @@ extern bool congratsShown;
 // Booster
 extern bool boosterActive;
 extern const Uint32 BOOSTER_DURATION;
-extern Uint32 boosterStartTime;
 extern std::map<int, bool> boosterActivated;
 struct Booster{
     int multiplier;
@@ -49,8 +48,8 @@ extern std::map<int, Booster> boosterSettings;
 // Blocker
 const int BLOCKER_VALUE = -1;
 
-// Time
-extern Uint32 newHighscoreTime;
+// How long the "New Record!" panel stays up.
+const Uint32 HIGHSCORE_TOAST_MS = 5000;
 
 // Volume settings.
 extern const int DEFAULT_VOLUME;
@@ -62,18 +61,14 @@ extern int sfxVolume;
 extern int incrementscore;
 extern int score;
 extern int highscore;
-extern int helpScrollOffset;
+extern float helpScrollOffset;
+extern float helpScrollVelocity;
 extern int emptyCells;
 
 // Index
 extern int currentGameoverIndex;
 extern int currentWinIndex;
 
-// Music.
-extern Mix_Music* bgMusic;
-extern Mix_Music* congratsMusic;
-extern Mix_Music* gameWinMusic;
-
 // Sound effects.
 extern Mix_Chunk* swipeSound;
 extern Mix_Chunk* gameOverSound;
@@ -83,7 +78,7 @@ extern SDL_Texture* optionBackground;
 extern SDL_Texture* startBackground;
 extern SDL_Texture* sidebarBackground;
 extern SDL_Texture* scoreBackground;
-extern SDL_Texture* recordBackground;
+extern LazyTexture* recordBackground;
 extern SDL_Texture* gameoverBackground;
 extern SDL_Texture* gamewonBackground;
 extern SDL_Texture* blockerTexture;
@@ -102,8 +97,8 @@ extern TTF_Font* boosterFont;
 extern TTF_Font* valueFont;
 
 extern std::map<int, SDL_Texture*> fruitTextures;
-extern std::map<int, SDL_Texture*> gamewinTextures;
-extern std::map<int, SDL_Texture*> gameoverTextures;
+extern std::map<int, LazyTexture*> gamewinTextures;
+extern std::map<int, LazyTexture*> gameoverTextures;
 
 #endif // GLOBALS_H
 
@@ -0,0 +1,243 @@
+#include "golden.h"
+#include "assets.h"
+#include "boosters.h"
+#include "game.h"
+#include "globals.h"
+#include "graphics.h"
+#include "log.h"
+#include "screens.h"
+#include "softrender.h"
+#include "textures.h"
+#include "timers.h"
+#include <SDL_ttf.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+struct GoldenScene {
+    const char* name;
+    UiScreen screen;
+};
+
+static const GoldenScene scenes[] = {
+    { "start",    UI_SCREEN_START },
+    { "grid",     UI_SCREEN_GAME },
+    { "options",  UI_SCREEN_OPTIONS },
+    { "help",     UI_SCREEN_HELP },
+    { "credits",  UI_SCREEN_CREDITS },
+    { "gameover", UI_SCREEN_GAMEOVER },
+    { "win",      UI_SCREEN_WIN },
+};
+
+// Every tile, two blockers and both timed boosters on screen. Timers are
+// armed while paused, so the bars always show the same time left.
+static void setUpBoard()
+{
+    static const int board[4][4] = {
+        {   2,             4,    8,            16 },
+        {  32, BLOCKER_VALUE,   64,             0 },
+        { 128,           256,    0, BLOCKER_VALUE },
+        { 512,          1024, 2048,             0 },
+    };
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            grid[i][j] = board[i][j];
+        }
+    }
+    score = 12345;
+    highscore = 23456;
+    incrementscore = 0;
+    newHighscoreAchieved = false;
+    currentGameoverIndex = 1;
+    currentWinIndex = 1;
+    helpScrollOffset = 0.0f;
+    helpScrollVelocity = 0.0f;
+    hammerActive = false;
+    tsunamiActive = false;
+    boosterActive = true;
+    currentBooster = boosterSettings[64];
+    scheduleTimer(TIMER_BOOSTER, 6000, boosterExpired);
+    freezeActive = true;
+    currentBoosterType = BOOSTER_FREEZE;
+    scheduleTimer(TIMER_FREEZE, 12000, freezeExpired);
+}
+
+// Text is rasterized by FreeType, so the goldens only hold for the library
+// versions they were made with. Those are recorded next to the images.
+static std::string libraryVersions()
+{
+    SDL_version sdl;
+    SDL_GetVersion(&sdl);
+    const SDL_version* ttf = TTF_Linked_Version();
+    int ftMajor = 0, ftMinor = 0, ftPatch = 0;
+    TTF_GetFreeTypeVersion(&ftMajor, &ftMinor, &ftPatch);
+
+    std::ostringstream out;
+    out << "SDL " << (int)sdl.major << "." << (int)sdl.minor << "." << (int)sdl.patch << "\n"
+        << "SDL_ttf " << (int)ttf->major << "." << (int)ttf->minor << "." << (int)ttf->patch << "\n"
+        << "FreeType " << ftMajor << "." << ftMinor << "." << ftPatch << "\n";
+    return out.str();
+}
+
+static std::string versionsPath()
+{
+    return std::string(GOLDEN_DIR) + "/VERSIONS.txt";
+}
+
+static bool writeVersions()
+{
+    std::ofstream out(versionsPath());
+    out << libraryVersions();
+    if (!out) {
+        LOG_ERROR(LOG_RENDER, "Cannot write %s", versionsPath().c_str());
+        return false;
+    }
+    return true;
+}
+
+static void checkVersions()
+{
+    std::ifstream in(versionsPath());
+    std::ostringstream recorded;
+    recorded << in.rdbuf();
+    std::string running = libraryVersions();
+    if (!in || recorded.str() == running)
+        return;
+    auto oneLine = [](std::string text) {
+        for (char& c : text) {
+            if (c == '\n')
+                c = ' ';
+        }
+        return text;
+    };
+    LOG_WARN(LOG_RENDER, "Goldens were made with %sbut this build runs %s; text may not match.",
+             oneLine(recorded.str()).c_str(), oneLine(running).c_str());
+}
+
+static std::string goldenPath(const GoldenScene& scene, const GoldenSize& size, const char* suffix)
+{
+    return std::string(GOLDEN_DIR) + "/" + scene.name + "_" + std::to_string(size.w)
+         + "x" + std::to_string(size.h) + suffix + ".bmp";
+}
+
+static bool savePixels(const std::vector<Uint32>& pixels, int w, int h, const std::string& path)
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)pixels.data(), w, h, 32, w * 4,
+                                                              SDL_PIXELFORMAT_ARGB8888);
+    bool saved = surface && SDL_SaveBMP(surface, path.c_str()) == 0;
+    if (!saved)
+        LOG_ERROR(LOG_RENDER, "Cannot write %s: %s", path.c_str(), SDL_GetError());
+    SDL_FreeSurface(surface);
+    return saved;
+}
+
+// Share of pixels outside the tolerance, or -1 if the golden is unusable.
+static double compareWithGolden(const std::vector<Uint32>& pixels, int w, int h, const std::string& path)
+{
+    SDL_Surface* loaded = SDL_LoadBMP(path.c_str());
+    if (!loaded)
+        return -1.0;
+    SDL_Surface* golden = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (!golden || golden->w != w || golden->h != h) {
+        SDL_FreeSurface(golden);
+        return -1.0;
+    }
+    long long differing = 0;
+    for (int y = 0; y < h; y++) {
+        const Uint32* expected = (const Uint32*)((const Uint8*)golden->pixels + y * golden->pitch);
+        const Uint32* actual = &pixels[(size_t)y * w];
+        for (int x = 0; x < w; x++) {
+            for (int shift = 0; shift < 24; shift += 8) {
+                int a = (actual[x] >> shift) & 0xFF;
+                int b = (expected[x] >> shift) & 0xFF;
+                if (std::abs(a - b) > GOLDEN_CHANNEL_TOLERANCE) {
+                    differing++;
+                    break;
+                }
+            }
+        }
+    }
+    SDL_FreeSurface(golden);
+    return (double)differing / ((double)w * h);
+}
+
+bool runGoldenImages(SDL_Window* window, SDL_Renderer* renderer, bool update)
+{
+    Uint32 startTicks = SDL_GetTicks();
+    setSoftwarePacing(false);
+    if (update) {
+#ifdef _WIN32
+        _mkdir(GOLDEN_DIR);
+#else
+        mkdir(GOLDEN_DIR, 0755);
+#endif
+    } else {
+        checkVersions();
+    }
+
+    // Everything a scene can show has to be resident before the first capture.
+    prefetchTexture(recordBackground);
+    prefetchTexture(gameoverTextures[1]);
+    prefetchTexture(gamewinTextures[1]);
+    while (assetsPending()) {
+        pumpAssetLoader(renderer, 10);
+    }
+
+    int failures = 0;
+    int images = 0;
+    for (const GoldenSize& size : GOLDEN_SIZES) {
+        SDL_SetWindowSize(window, size.w, size.h);
+        SDL_PumpEvents();
+        recomputeLayout(window);
+
+        std::vector<Uint32> pixels((size_t)size.w * size.h);
+        for (const GoldenScene& scene : scenes) {
+            changeScreen(scene.screen);
+            pauseTimers();
+            setUpBoard();
+            renderScreen(renderer);
+            if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888,
+                                     pixels.data(), size.w * 4) != 0) {
+                LOG_ERROR(LOG_RENDER, "Cannot read back %s: %s", scene.name, SDL_GetError());
+                failures++;
+                continue;
+            }
+            images++;
+
+            std::string path = goldenPath(scene, size, "");
+            if (update) {
+                if (!savePixels(pixels, size.w, size.h, path))
+                    failures++;
+                continue;
+            }
+            double diff = compareWithGolden(pixels, size.w, size.h, path);
+            if (diff < 0.0) {
+                LOG_ERROR(LOG_RENDER, "%s: missing or wrong size; run with --golden-update", path.c_str());
+                failures++;
+            } else if (diff > GOLDEN_MAX_DIFF_FRACTION) {
+                std::string actualPath = goldenPath(scene, size, ".actual");
+                LOG_ERROR(LOG_RENDER, "%s: %.3f%% of pixels differ, wrote %s",
+                          path.c_str(), diff * 100.0, actualPath.c_str());
+                savePixels(pixels, size.w, size.h, actualPath);
+                failures++;
+            }
+        }
+    }
+
+    if (update && !writeVersions())
+        failures++;
+
+    changeScreen(UI_SCREEN_START);
+    LOG_INFO(LOG_RENDER, "Golden images: %d %s, %d failed, %u ms.", images,
+             update ? "written" : "checked", failures, SDL_GetTicks() - startTicks);
+    return failures == 0;
+}
@@ -0,0 +1,28 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <SDL.h>
+
+// Golden-image mode (--golden, --golden-update). Every screen is drawn from
+// a fixed board at each size below with the software renderer on an
+// offscreen window, and the pixels are compared with the BMPs stored in
+// GOLDEN_DIR. Runs without a display; the exit code reports the result.
+
+const char* const GOLDEN_DIR = "assets/golden";
+
+struct GoldenSize {
+    int w;
+    int h;
+};
+const GoldenSize GOLDEN_SIZES[] = { { 1100, 700 }, { 1920, 1080 } };
+
+// A pixel differs when any channel is off by more than this...
+const int GOLDEN_CHANNEL_TOLERANCE = 8;
+// ...and an image fails when more than this share of its pixels differ.
+const double GOLDEN_MAX_DIFF_FRACTION = 0.001;
+
+// Renders and checks every screen, or rewrites the goldens when update is
+// set. Returns false if any image is missing or differs.
+bool runGoldenImages(SDL_Window* window, SDL_Renderer* renderer, bool update);
+
+#endif // GOLDEN_H
@@ -1,19 +1,32 @@
 #include "boosters.h"
+#include "camera.h"
+#include "capture.h"
 #include "graphics.h"
 #include "globals.h"
 #include "game.h"
+#include "history.h"
 #include "textures.h"
+#include "timers.h"
+#include "diagnostics.h"
+#include "drawlist.h"
 #include "font.h"
+#include "latency.h"
+#include "marathon.h"
+#include "quality.h"
+#include "softrender.h"
+#include "ui.h"
+#include "log.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <ctime>
 #include <cstdlib>
 #include <string>
-#include <iostream>
 #include <map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
 
 void recomputeLayout(SDL_Window* window)
 {
@@ -32,73 +45,202 @@ void recomputeLayout(SDL_Window* window)
         SIDEBAR_WIDTH = 0;
         GAME_AREA_WIDTH = actualW;
         TILE_SIZE = actualW / GRID_SIZE;
-        std::cerr << "Warning: Not enough width for sidebar, using full width for grid.\n";
+        LOG_WARN(LOG_RENDER, "Not enough width for sidebar, using full width for grid.");
     }
+    invalidateTextPages();
+    freeScaledCopies();
+    updateFrameBudget(window);
+    resetCamera();
+    layoutUi();
 }
 
-void draw_start_screen(SDL_Renderer* renderer)
+// Every screen finishes through here: overlays are queued on top, the frame
+// is submitted, handed to the recorder and presented once.
+static void presentFrame(SDL_Renderer* renderer)
 {
-    SDL_SetRenderDrawColor(renderer, 187, 173, 160, 255);
-    SDL_RenderClear(renderer);
+    drawDiagnostics(renderer);
+    submitDrawList(renderer);
+    endFrameTiming();
+    captureFrame(renderer);
+    presentRenderer(renderer);
+    markFramePresented();
+}
 
-    if (startBackground) {
+// Full-window art, or just the clear color until it has loaded.
+static void queueBackground(SDL_Texture* background)
+{
+    if (background) {
         SDL_Rect destRect = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
-        SDL_RenderCopy(renderer, startBackground, nullptr, &destRect);
+        queueScaled(LAYER_BACKGROUND, background, destRect);
     }
+}
 
-    SDL_RenderPresent(renderer);
+void draw_start_screen(SDL_Renderer* renderer)
+{
+    queueClear({ 187, 173, 160, 255 });
+    queueBackground(startBackground);
+    presentFrame(renderer);
 }
 
-void draw_grid(SDL_Renderer* renderer, TTF_Font* font) {
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-    if (gridBackground) {
-        SDL_Rect destRect = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
-        SDL_RenderCopy(renderer, gridBackground, NULL, &destRect);
+const int TILE_TEXTURE_SLOTS = 256;
+
+// Tile art indexed by packed cell, so a cell finds its texture without a map
+// lookup; the blocker sits at PACKED_BLOCKER. Tiles past the last fruit
+// (4096 and up, routine on big boards) show the top fruit with their value
+// written over it, and a tile whose fruit has not loaded yet is a plain
+// square with its value.
+struct TileArt {
+    SDL_Texture* byExponent[TILE_TEXTURE_SLOTS];
+    bool labelled[TILE_TEXTURE_SLOTS];
+    FrameText labels[TILE_TEXTURE_SLOTS];   // Rasterized on first use in the frame.
+};
+
+static void prepareTileArt(TileArt& art)
+{
+    int top = 0;
+    for (int i = 0; i < TILE_TEXTURE_SLOTS; i++) {
+        art.byExponent[i] = nullptr;
+        art.labelled[i] = false;
+        art.labels[i] = { nullptr, 0, 0 };
+    }
+    for (const auto& pair : fruitTextures) {
+        int cell = packCell(pair.first);
+        art.byExponent[cell] = pair.second;
+        top = std::max(top, cell);
+    }
+    for (int i = 1; i < PACKED_BLOCKER; i++) {
+        if (!art.byExponent[i]) {
+            art.byExponent[i] = i > top ? art.byExponent[top] : nullptr;
+            art.labelled[i] = true;
+        }
     }
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            int value = grid[i][j];
-            SDL_Rect rect = { j * TILE_SIZE, i * TILE_SIZE, TILE_SIZE, TILE_SIZE };
-            if (value == BLOCKER_VALUE) {
-                if (blockerTexture) {
-                    SDL_RenderCopy(renderer, blockerTexture, NULL, &rect);
-                }
-            }
-            else if (value != 0 && fruitTextures.count(value)) {
-                SDL_Texture* tex = fruitTextures[value];
-                SDL_Rect destRect = { rect.x, rect.y, TILE_SIZE, TILE_SIZE };
-                SDL_RenderCopy(renderer, tex, NULL, &destRect);
-            }
+    art.byExponent[PACKED_BLOCKER] = blockerTexture;
+}
+
+// One occupied cell at rect. Nothing is drawn outside clip, when set.
+static void queueTile(SDL_Renderer* renderer, TileArt& art, Uint8 cell, const SDL_Rect& rect, const SDL_Rect* clip)
+{
+    if (cell == 0)
+        return;
+    SDL_Texture* tex = art.byExponent[cell];
+    if (tex) {
+        queueScaled(LAYER_BOARD, tex, rect, clip);
+    } else {
+        SDL_Rect square = rect;
+        if (!clip || SDL_IntersectRect(&rect, clip, &square))
+            queueFill(LAYER_BOARD, cell == PACKED_BLOCKER ? SDL_Color{ 90, 90, 90, 255 } : SDL_Color{ 237, 194, 46, 255 },
+                      square);
+    }
+    if (!art.labelled[cell])
+        return;
+
+    FrameText& label = art.labels[cell];
+    if (!label.texture)
+        label = frameText(renderer, valueFont, std::to_string(unpackCell(cell)).c_str(), { 255, 255, 255, 255 }, true);
+    if (!label.texture)
+        return;
+    // Shrunk to fit the tile, never enlarged, and kept whole inside the clip.
+    float fit = std::min(1.0f, std::min(rect.w * 0.8f / label.w, rect.h * 0.5f / label.h));
+    int w = std::max(1, (int)(label.w * fit));
+    int h = std::max(1, (int)(label.h * fit));
+    SDL_Rect dest = { rect.x + (rect.w - w) / 2, rect.y + (rect.h - h) / 2, w, h };
+    if (clip && (dest.x < clip->x || dest.y < clip->y || dest.x + dest.w > clip->x + clip->w
+                 || dest.y + dest.h > clip->y + clip->h))
+        return;
+    SDL_Rect backing = { dest.x - 2, dest.y, dest.w + 4, dest.h };
+    queueFill(LAYER_BOARD_FRONT, { 0, 0, 0, 140 }, backing, SDL_BLENDMODE_BLEND);
+    queueCopy(LAYER_BOARD_TEXT, label.texture, nullptr, dest);
+}
+
+// Only the cells in view are queued, and they batch into one call per tile
+// texture, so the cost tracks the view rather than the board.
+static void drawBoardTiles(SDL_Renderer* renderer)
+{
+    TileArt art;
+    prepareTileArt(art);
+    int row0, row1, col0, col1;
+    cameraVisibleCells(&row0, &row1, &col0, &col1);
+    SDL_Rect view = { 0, 0, GAME_AREA_WIDTH, GAME_AREA_WIDTH };
+    for (int i = row0; i < row1; i++) {
+        for (int j = col0; j < col1; j++) {
+            queueTile(renderer, art, packCell(grid[i][j]), cameraCellRect(i, j), &view);
         }
     }
+}
+
+void draw_grid(SDL_Renderer* renderer, TTF_Font* font) {
+    queueClear({ 0, 0, 0, 255 });
+    setScaledRegion({ 0, 0, GAME_AREA_WIDTH, WINDOW_HEIGHT });
+    if (backgroundArtEnabled())
+        queueBackground(gridBackground);
+    drawBoardTiles(renderer);
     draw_sidebar(renderer, valueFont, smallFont);
-    SDL_RenderPresent(renderer);
+    presentFrame(renderer);
+}
+
+// Every board in one pass: the frames batch into one fill call, the tiles of
+// all boards into one geometry call per texture, the dimming into one more.
+void draw_marathon_screen(SDL_Renderer* renderer, TTF_Font* font)
+{
+    queueClear({ 0, 0, 0, 255 });
+    setScaledRegion({ 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT });
+    if (backgroundArtEnabled())
+        queueBackground(gridBackground);
+
+    int count;
+    const MarathonBoard* boards = marathonBoards(&count);
+    const int header = 40, gap = 8;
+    int cols = (int)std::ceil(std::sqrt((double)count));
+    int rows = (count + cols - 1) / cols;
+    int boardSize = std::min((WINDOW_WIDTH - gap) / cols, (WINDOW_HEIGHT - header - gap) / rows) - gap;
+    int tile = std::max(1, boardSize / CLASSIC_GRID_SIZE);
+    boardSize = tile * CLASSIC_GRID_SIZE;
+    int left = (WINDOW_WIDTH - cols * (boardSize + gap) + gap) / 2;
+
+    TileArt art;
+    prepareTileArt(art);
+    for (int n = 0; n < count; n++) {
+        SDL_Rect frame = { left + (n % cols) * (boardSize + gap), header + (n / cols) * (boardSize + gap),
+                           boardSize, boardSize };
+        queueFill(LAYER_BOARD_BACK, { 0, 0, 0, 90 }, frame, SDL_BLENDMODE_BLEND);
+        if (boards[n].over)
+            queueFill(LAYER_BOARD_FRONT, { 0, 0, 0, 160 }, frame, SDL_BLENDMODE_BLEND);
+        for (int i = 0; i < CLASSIC_GRID_SIZE; i++) {
+            for (int j = 0; j < CLASSIC_GRID_SIZE; j++) {
+                SDL_Rect rect = { frame.x + j * tile, frame.y + i * tile, tile, tile };
+                queueTile(renderer, art, boards[n].cells[i][j], rect, nullptr);
+            }
+        }
+    }
+
+    std::ostringstream status;
+    status << count << " boards   " << marathonGamesFinished() << " games finished   "
+           << marathonMovesPerSecond() << " moves/s   "
+           << (marathonAutoplay() ? "Autoplay (A: take over)" : "Arrows move all boards (A: autoplay, R: deal again)");
+    FrameText text = frameText(renderer, font, status.str().c_str(), { 255, 255, 255, 255 }, true);
+    queueText(LAYER_TEXT, text, gap, (header - text.h) / 2);
+    presentFrame(renderer);
+}
+
+// A label centered in box.
+static void queueCenteredText(const FrameText& text, const SDL_Rect& box)
+{
+    queueText(LAYER_TEXT, text, box.x + (box.w - text.w) / 2, box.y + (box.h - text.h) / 2);
 }
 
 void draw_sidebar(SDL_Renderer* renderer, TTF_Font* valueFont, TTF_Font* smallFont) {
     SDL_Rect sidebarRect = { GAME_AREA_WIDTH, 0, SIDEBAR_WIDTH, WINDOW_HEIGHT };
     if (sidebarBackground) {
-        SDL_RenderCopy(renderer, sidebarBackground, nullptr, &sidebarRect);
+        queueScaled(LAYER_PANEL, sidebarBackground, sidebarRect);
     } else {
-        SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);
-        SDL_RenderFillRect(renderer, &sidebarRect);
+        queueFill(LAYER_PANEL, { 150, 150, 150, 255 }, sidebarRect);
     }
 
     SDL_Color textColor = {0, 0, 0, 255};
     SDL_Color incrementColor = {0, 255, 0, 255};
 
-    std::string scoreTitle = "Score";
-    SDL_Surface* scoreTitleSurface = TTF_RenderText_Solid(smallFont, scoreTitle.c_str(), textColor);
-    if (scoreTitleSurface) {
-        SDL_Texture* scoreTitleTexture = SDL_CreateTextureFromSurface(renderer, scoreTitleSurface);
-        int titleX = GAME_AREA_WIDTH + (SIDEBAR_WIDTH - scoreTitleSurface->w) / 2;
-        int titleY = 70;
-        SDL_Rect titleRect = { titleX, titleY, scoreTitleSurface->w, scoreTitleSurface->h };
-        SDL_RenderCopy(renderer, scoreTitleTexture, nullptr, &titleRect);
-        SDL_FreeSurface(scoreTitleSurface);
-        SDL_DestroyTexture(scoreTitleTexture);
-    }
+    FrameText scoreTitle = frameText(renderer, smallFont, "Score", textColor);
+    queueText(LAYER_TEXT, scoreTitle, GAME_AREA_WIDTH + (SIDEBAR_WIDTH - scoreTitle.w) / 2, 70);
 
     if (scoreBackground) {
         SDL_Rect scoreBgRect;
@@ -106,62 +248,26 @@ void draw_sidebar(SDL_Renderer* renderer, TTF_Font* valueFont, TTF_Font* smallFo
         scoreBgRect.h = 70;
         scoreBgRect.x = GAME_AREA_WIDTH + (SIDEBAR_WIDTH - scoreBgRect.w) / 2;
         scoreBgRect.y = 120;
-        SDL_RenderCopy(renderer, scoreBackground, nullptr, &scoreBgRect);
+        queueCopy(LAYER_DECOR, scoreBackground, nullptr, scoreBgRect);
 
+        FrameText scoreText = frameText(renderer, smallFont, std::to_string(score).c_str(), textColor);
         if (incrementscore > 0) {
-            SDL_Surface* scoreSurface = TTF_RenderText_Solid(smallFont, std::to_string(score).c_str(), textColor);
-            SDL_Surface* incrementSurface = TTF_RenderText_Solid(smallFont, (" + " + std::to_string(incrementscore)).c_str(), incrementColor);
-            if (scoreSurface && incrementSurface) {
+            FrameText incrementText = frameText(renderer, smallFont, (" + " + std::to_string(incrementscore)).c_str(), incrementColor);
+            if (scoreText.texture && incrementText.texture) {
                 const int spacing = 0;
-                int totalWidth = scoreSurface->w + spacing + incrementSurface->w;
+                int totalWidth = scoreText.w + spacing + incrementText.w;
                 int startX = scoreBgRect.x + (scoreBgRect.w - totalWidth) / 2;
-                int scoreY = scoreBgRect.y + (scoreBgRect.h - scoreSurface->h) / 2;
-                int incrementY = scoreBgRect.y + (scoreBgRect.h - incrementSurface->h) / 2;
-
-                SDL_Texture* scoreTexture = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-                SDL_Texture* incrementTexture = SDL_CreateTextureFromSurface(renderer, incrementSurface);
-                SDL_FreeSurface(scoreSurface);
-                SDL_FreeSurface(incrementSurface);
-
-                SDL_Rect scoreRect = { startX, scoreY, 0, 0 };
-                SDL_QueryTexture(scoreTexture, NULL, NULL, &scoreRect.w, &scoreRect.h);
-                SDL_Rect incrementRect = { startX + scoreRect.w + spacing, incrementY, 0, 0 };
-                SDL_QueryTexture(incrementTexture, NULL, NULL, &incrementRect.w, &incrementRect.h);
-
-                SDL_RenderCopy(renderer, scoreTexture, nullptr, &scoreRect);
-                SDL_RenderCopy(renderer, incrementTexture, nullptr, &incrementRect);
-
-                SDL_DestroyTexture(scoreTexture);
-                SDL_DestroyTexture(incrementTexture);
+                queueText(LAYER_TEXT, scoreText, startX, scoreBgRect.y + (scoreBgRect.h - scoreText.h) / 2);
+                queueText(LAYER_TEXT, incrementText, startX + scoreText.w + spacing,
+                          scoreBgRect.y + (scoreBgRect.h - incrementText.h) / 2);
             }
         } else {
-            SDL_Surface* scoreSurface = TTF_RenderText_Solid(smallFont, std::to_string(score).c_str(), textColor);
-            if (scoreSurface) {
-                SDL_Texture* scoreTexture = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-                SDL_Rect scoreRect = {
-                    scoreBgRect.x + (scoreBgRect.w - scoreSurface->w) / 2,
-                    scoreBgRect.y + (scoreBgRect.h - scoreSurface->h) / 2,
-                    scoreSurface->w,
-                    scoreSurface->h
-                };
-                SDL_FreeSurface(scoreSurface);
-                SDL_RenderCopy(renderer, scoreTexture, nullptr, &scoreRect);
-                SDL_DestroyTexture(scoreTexture);
-            }
+            queueCenteredText(scoreText, scoreBgRect);
         }
     }
 
-    std::string highTitle = "Highscore";
-    SDL_Surface* highTitleSurface = TTF_RenderText_Solid(smallFont, highTitle.c_str(), textColor);
-    if (highTitleSurface) {
-        SDL_Texture* highTitleTexture = SDL_CreateTextureFromSurface(renderer, highTitleSurface);
-        int highTitleX = GAME_AREA_WIDTH + (SIDEBAR_WIDTH - highTitleSurface->w) / 2;
-        int highTitleY = 200;
-        SDL_Rect highTitleRect = { highTitleX, highTitleY, highTitleSurface->w, highTitleSurface->h };
-        SDL_RenderCopy(renderer, highTitleTexture, nullptr, &highTitleRect);
-        SDL_FreeSurface(highTitleSurface);
-        SDL_DestroyTexture(highTitleTexture);
-    }
+    FrameText highTitle = frameText(renderer, smallFont, "Highscore", textColor);
+    queueText(LAYER_TEXT, highTitle, GAME_AREA_WIDTH + (SIDEBAR_WIDTH - highTitle.w) / 2, 200);
 
     if (scoreBackground) {
         SDL_Rect highBgRect;
@@ -169,25 +275,11 @@ void draw_sidebar(SDL_Renderer* renderer, TTF_Font* valueFont, TTF_Font* smallFo
         highBgRect.h = 70;
         highBgRect.x = GAME_AREA_WIDTH + (SIDEBAR_WIDTH - highBgRect.w) / 2;
         highBgRect.y = 250;
-        SDL_RenderCopy(renderer, scoreBackground, nullptr, &highBgRect);
-
-        std::string highscoreText = std::to_string(highscore);
-        SDL_Surface* highSurface = TTF_RenderText_Solid(smallFont, highscoreText.c_str(), textColor);
-        if (highSurface) {
-            SDL_Texture* highTexture = SDL_CreateTextureFromSurface(renderer, highSurface);
-            SDL_Rect highRect;
-            highRect.w = highSurface->w;
-            highRect.h = highSurface->h;
-            highRect.x = highBgRect.x + (highBgRect.w - highSurface->w) / 2;
-            highRect.y = highBgRect.y + (highBgRect.h - highSurface->h) / 2;
-            SDL_RenderCopy(renderer, highTexture, nullptr, &highRect);
-            SDL_FreeSurface(highSurface);
-            SDL_DestroyTexture(highTexture);
-        }
+        queueCopy(LAYER_DECOR, scoreBackground, nullptr, highBgRect);
+        queueCenteredText(frameText(renderer, smallFont, std::to_string(highscore).c_str(), textColor), highBgRect);
     }
     if (boosterActive) {
-    Uint32 elapsed = SDL_GetTicks() - boosterStartTime;
-    Uint32 remaining = (elapsed < BOOSTER_DURATION) ? (BOOSTER_DURATION - elapsed) : 0;
+    Uint32 remaining = SDL_min(timerRemaining(TIMER_BOOSTER), BOOSTER_DURATION);
     int fullBarWidth = 300;
     int currentBarWidth = static_cast<int>((remaining / (float)BOOSTER_DURATION) * fullBarWidth);
 
@@ -198,11 +290,8 @@ void draw_sidebar(SDL_Renderer* renderer, TTF_Font* valueFont, TTF_Font* smallFo
         30
     };
 
-    SDL_SetRenderDrawColor(renderer, 0, 225, 0, 255);
-    SDL_RenderFillRect(renderer, &boosterBarRect);
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderDrawRect(renderer, &boosterBarRect);
+    queueFill(LAYER_CONTROL, { 0, 225, 0, 255 }, boosterBarRect);
+    queueOutline(LAYER_CONTROL, { 0, 0, 0, 255 }, boosterBarRect);
 
     double secondsRemaining = remaining / 1000.0;
 
@@ -217,64 +306,138 @@ void draw_sidebar(SDL_Renderer* renderer, TTF_Font* valueFont, TTF_Font* smallFo
 
     std::string boosterLabel = "Booster Active! x" + multStr +
                                " (" + timeStr + "s)";
-    SDL_Surface* boosterLabelSurf = TTF_RenderText_Solid(boosterFont, boosterLabel.c_str(), textColor);
-    if (boosterLabelSurf) {
-        SDL_Texture* boosterLabelTex = SDL_CreateTextureFromSurface(renderer, boosterLabelSurf);
-        SDL_Rect boosterLabelRect = {
-            GAME_AREA_WIDTH + (SIDEBAR_WIDTH - boosterLabelSurf->w) / 2,
-            boosterBarRect.y - boosterLabelSurf->h - 5,
-            boosterLabelSurf->w,
-            boosterLabelSurf->h
-        };
-        SDL_FreeSurface(boosterLabelSurf);
-        SDL_RenderCopy(renderer, boosterLabelTex, nullptr, &boosterLabelRect);
-        SDL_DestroyTexture(boosterLabelTex);
-    }
+    FrameText boosterText = frameText(renderer, boosterFont, boosterLabel.c_str(), textColor);
+    queueText(LAYER_TEXT, boosterText, GAME_AREA_WIDTH + (SIDEBAR_WIDTH - boosterText.w) / 2,
+              boosterBarRect.y - boosterText.h - 5);
 }
-    if (newHighscoreAchieved && recordBackground) {
+    SDL_Texture* recordTexture = newHighscoreAchieved ? useTexture(recordBackground) : nullptr;
+    if (newHighscoreAchieved && recordTexture) {
         SDL_Rect congratsRect;
         congratsRect.w = 250;
         congratsRect.h = 150;
         congratsRect.x = GAME_AREA_WIDTH + (SIDEBAR_WIDTH - congratsRect.w) / 2;
         congratsRect.y = WINDOW_HEIGHT - 260;
-        SDL_RenderCopy(renderer, recordBackground, nullptr, &congratsRect);
-
-        std::string congratsMsg = "Congratulations!\nNew Record!";
-        SDL_Surface* congratsSurface = TTF_RenderText_Blended_Wrapped(valueFont, congratsMsg.c_str(), textColor, congratsRect.w - 10);
-        if (congratsSurface) {
-            SDL_Texture* congratsTexture = SDL_CreateTextureFromSurface(renderer, congratsSurface);
-            SDL_Rect congratsTextRect;
-            congratsTextRect.w = congratsSurface->w;
-            congratsTextRect.h = congratsSurface->h;
-            congratsTextRect.x = congratsRect.x + (congratsRect.w - congratsSurface->w) / 2 + 50;
-            congratsTextRect.y = congratsRect.y + (congratsRect.h - congratsSurface->h) / 2;
-            SDL_RenderCopy(renderer, congratsTexture, nullptr, &congratsTextRect);
-            SDL_FreeSurface(congratsSurface);
-            SDL_DestroyTexture(congratsTexture);
-        }
-        if (newHighscoreAchieved && (SDL_GetTicks() - newHighscoreTime >= 5000)) {
-            newHighscoreAchieved = false;
-        }
+        queueCopy(LAYER_DECOR, recordTexture, nullptr, congratsRect);
+
+        FrameText congratsText = frameText(renderer, valueFont, "Congratulations!\nNew Record!",
+                                           textColor, true, congratsRect.w - 10);
+        queueText(LAYER_TEXT, congratsText, congratsRect.x + (congratsRect.w - congratsText.w) / 2 + 50,
+                  congratsRect.y + (congratsRect.h - congratsText.h) / 2);
     }
     drawBoosterIcons(renderer);
     if (freezeActive) {
         drawFreezeBoosterDuration(renderer, boosterFont);
     }
-    SDL_Rect optionButtonRect = { GAME_AREA_WIDTH + 10, WINDOW_HEIGHT - 60, SIDEBAR_WIDTH - 20, 50 };
-    drawCloudButtonWithText(renderer, cloudTexture, optionButtonRect, "Options", smallFont);
+    drawUiButtons(renderer, UI_SCREEN_GAME, smallFont);
+}
+
+
+// Help and credits text never changes, so it is rasterized once into a
+// render target and only rebuilt when the window is resized.
+struct TextPage {
+    SDL_Texture* texture = nullptr;
+    size_t bytes = 0;
+    int width = 0;
+    int height = 0;
+};
+
+static TextPage helpPage;
+static TextPage creditsPage;
+static Uint32 lastHelpScrollTick = 0;
+
+static void freeTextPage(TextPage& page)
+{
+    if (page.texture) {
+        SDL_DestroyTexture(page.texture);
+        untrackTextureBytes(TEXTURE_TEXT, page.bytes);
+        page.texture = nullptr;
+        page.bytes = 0;
+    }
+    page.width = 0;
+    page.height = 0;
+}
 
-    SDL_RenderPresent(renderer);
+void invalidateTextPages()
+{
+    freeTextPage(helpPage);
+    freeTextPage(creditsPage);
 }
 
+void freeTextPages()
+{
+    invalidateTextPages();
+}
 
-void draw_help_screen(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont)
+void freeHelpPage()
+{
+    freeTextPage(helpPage);
+}
+
+void freeCreditsPage()
+{
+    freeTextPage(creditsPage);
+}
+
+// Renders centered lines into a transparent target texture. Each line
+// advances by its font's line skip, or by its surface height plus `gap`
+// when `useLineSkip` is false.
+static bool buildTextPage(SDL_Renderer* renderer, TextPage& page,
+                          const std::vector<std::pair<std::string, TTF_Font*>>& lines,
+                          int topPadding, bool useLineSkip, int gap)
 {
+    freeTextPage(page);
+    int totalHeight = topPadding;
+    for (const auto &line : lines) {
+        int w = 0, h = TTF_FontLineSkip(line.second);
+        if (!useLineSkip && !line.first.empty())
+            TTF_SizeText(line.second, line.first.c_str(), &w, &h);
+        totalHeight += useLineSkip ? h : h + gap;
+    }
+
+    page.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, totalHeight);
+    if (!page.texture) {
+        LOG_ERROR(LOG_RENDER, "Failed to create text page texture: %s", SDL_GetError());
+        return false;
+    }
+    page.width = WINDOW_WIDTH;
+    page.height = totalHeight;
+    page.bytes = textureSizeBytes(page.texture);
+    trackTextureBytes(TEXTURE_TEXT, page.bytes);
+    SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, page.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
     SDL_RenderClear(renderer);
-    if (optionBackground) {
-        SDL_Rect destRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-        SDL_RenderCopy(renderer, optionBackground, NULL, &destRect);
-    }
+
     SDL_Color textColor = {0, 0, 0, 255};
+    int y = topPadding;
+    for (const auto &line : lines) {
+        int advance = TTF_FontLineSkip(line.second);
+        SDL_Surface* textSurface = line.first.empty() ? nullptr
+            : TTF_RenderText_Solid(line.second, line.first.c_str(), textColor);
+        if (textSurface) {
+            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
+            SDL_Rect textRect = { (page.width - textSurface->w) / 2, y, textSurface->w, textSurface->h };
+            if (!useLineSkip)
+                advance = textSurface->h + gap;
+            SDL_FreeSurface(textSurface);
+            SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
+            SDL_DestroyTexture(textTexture);
+        }
+        else if (!useLineSkip) {
+            advance += gap;
+        }
+        y += advance;
+    }
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    return true;
+}
+
+static void buildHelpPage(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont)
+{
     std::vector<std::pair<std::string, TTF_Font*>> lines;
 
     lines.push_back({ "Welcome to 2048 Fruits!", titleFont });
@@ -317,342 +480,238 @@ void draw_help_screen(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* sma
     lines.push_back({ "- Watermelon: 2048 points", smallFont });
     lines.push_back({ "", smallFont });
 
-    int totalHeight = 0;
-    for (auto &line : lines) {
-        totalHeight += TTF_FontLineSkip(line.second);
-    }
-    if (helpScrollOffset < 0)
+    buildTextPage(renderer, helpPage, lines, 10, true, 0);
+}
+
+// Integrates the scroll velocity with exponential friction and clamps the
+// offset to the page, killing the velocity when an edge is hit.
+static void updateHelpScroll()
+{
+    Uint32 now = SDL_GetTicks();
+    float dt = (lastHelpScrollTick == 0) ? 0.0f : (now - lastHelpScrollTick) / 1000.0f;
+    if (dt > 0.05f)
+        dt = 0.05f;
+    lastHelpScrollTick = now;
+
+    helpScrollOffset += helpScrollVelocity * dt;
+    helpScrollVelocity *= std::pow(HELP_SCROLL_FRICTION, dt);
+    if (std::fabs(helpScrollVelocity) < 5.0f)
+        helpScrollVelocity = 0.0f;
+
+    float maxOffset = (float)(helpPage.height - WINDOW_HEIGHT);
+    if (helpScrollOffset < 0) {
         helpScrollOffset = 0;
-    if (helpScrollOffset > totalHeight - WINDOW_HEIGHT)
-        helpScrollOffset = totalHeight - WINDOW_HEIGHT;
-    int y = 10 - helpScrollOffset;
-    for (auto &line : lines) {
-        SDL_Surface* textSurface = TTF_RenderText_Solid(line.second, line.first.c_str(), textColor);
-        if (textSurface) {
-            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-            SDL_Rect textRect = { (WINDOW_WIDTH - textSurface->w) / 2, y, textSurface->w, textSurface->h };
-            y += TTF_FontLineSkip(line.second);
-            SDL_FreeSurface(textSurface);
-            SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-            SDL_DestroyTexture(textTexture);
-        }
+        helpScrollVelocity = 0.0f;
+    }
+    if (helpScrollOffset > maxOffset) {
+        helpScrollOffset = maxOffset;
+        helpScrollVelocity = 0.0f;
     }
-
-    SDL_Rect closeButtonRect = { WINDOW_WIDTH - DEFAULT_CLOUD_BTN_WIDTH - 20, WINDOW_HEIGHT - DEFAULT_CLOUD_BTN_HEIGHT - 20, DEFAULT_CLOUD_BTN_WIDTH, DEFAULT_CLOUD_BTN_HEIGHT };
-    drawCloudButtonWithText(renderer, cloudTexture, closeButtonRect, "Close", smallFont);
-
-    SDL_RenderPresent(renderer);
 }
 
-void draw_credits_screen(SDL_Renderer* renderer,
-                         TTF_Font* titleFont,
-                         TTF_Font* smallFont,
-                         TTF_Font* buttonFont)
+void draw_help_screen(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont)
 {
-    SDL_RenderClear(renderer);
-    if (optionBackground) {
-        SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-        SDL_RenderCopy(renderer, optionBackground, NULL, &bgRect);
-    }
-    SDL_Color textColor = {0, 0, 0, 255};
+    queueBackground(optionBackground);
 
-    std::string creditsTitle = "Credits";
-    SDL_Surface* titleSurface = TTF_RenderText_Solid(titleFont, creditsTitle.c_str(), textColor);
-    if (titleSurface) {
-        SDL_Texture* titleTexture = SDL_CreateTextureFromSurface(renderer, titleSurface);
-        SDL_Rect titleRect = { (WINDOW_WIDTH - titleSurface->w) / 2, 20, titleSurface->w, titleSurface->h };
-        SDL_FreeSurface(titleSurface);
-        SDL_RenderCopy(renderer, titleTexture, NULL, &titleRect);
-        SDL_DestroyTexture(titleTexture);
+    if (!helpPage.texture)
+        buildHelpPage(renderer, titleFont, smallFont);
+    updateHelpScroll();
+
+    if (helpPage.texture) {
+        int offset = (int)helpScrollOffset;
+        SDL_Rect srcRect = { 0, offset < 0 ? 0 : offset, helpPage.width, 0 };
+        SDL_Rect destRect = { 0, offset < 0 ? -offset : 0, helpPage.width, 0 };
+        srcRect.h = std::min(helpPage.height - srcRect.y, WINDOW_HEIGHT - destRect.y);
+        destRect.h = srcRect.h;
+        if (srcRect.h > 0)
+            queueCopy(LAYER_PANEL, helpPage.texture, &srcRect, destRect);
     }
 
+    drawUiButtons(renderer, UI_SCREEN_HELP, smallFont);
+
+    presentFrame(renderer);
+}
+
+static void buildCreditsPage(SDL_Renderer* renderer, TTF_Font* smallFont)
+{
     std::string creditsText = "Developed by NGUYEN HUNG SON\n\n\nPROPS TO DATSKII FOR THE LOVELY ARTWORK";
     std::istringstream iss(creditsText);
-    std::vector<std::string> lines;
+    std::vector<std::pair<std::string, TTF_Font*>> lines;
     std::string line;
     while (std::getline(iss, line)) {
-        lines.push_back(line);
-    }
-    int y = 120;
-    for (const auto &l : lines) {
-        SDL_Surface* lineSurface = TTF_RenderText_Solid(smallFont, l.c_str(), textColor);
-        if (lineSurface) {
-            SDL_Texture* lineTexture = SDL_CreateTextureFromSurface(renderer, lineSurface);
-            SDL_Rect lineRect = { (WINDOW_WIDTH - lineSurface->w) / 2, y, lineSurface->w, lineSurface->h };
-            y += lineSurface->h + 5;
-            SDL_FreeSurface(lineSurface);
-            SDL_RenderCopy(renderer, lineTexture, NULL, &lineRect);
-            SDL_DestroyTexture(lineTexture);
-        }
+        lines.push_back({ line, smallFont });
     }
-
-    SDL_Rect backBtn = { WINDOW_WIDTH - DEFAULT_CLOUD_BTN_WIDTH - 20, WINDOW_HEIGHT - DEFAULT_CLOUD_BTN_HEIGHT - 20, DEFAULT_CLOUD_BTN_WIDTH, DEFAULT_CLOUD_BTN_HEIGHT };
-    drawCloudButtonWithText(renderer, cloudTexture, backBtn, "Back", buttonFont);
-
-    SDL_RenderPresent(renderer);
+    buildTextPage(renderer, creditsPage, lines, 0, false, 5);
 }
 
-void draw_options_screen(SDL_Renderer* renderer,
-                         TTF_Font* buttonFont,
-                         TTF_Font* titleFont)
+// A screen title centered at the top.
+static void queueTitle(SDL_Renderer* renderer, TTF_Font* font, const char* title)
 {
-    SDL_RenderClear(renderer);
-    if (optionBackground) {
-        SDL_Rect bgRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
-        SDL_RenderCopy(renderer, optionBackground, NULL, &bgRect);
-    }
+    FrameText text = frameText(renderer, font, title, {0, 0, 0, 255});
+    queueText(LAYER_TEXT, text, (WINDOW_WIDTH - text.w) / 2, 20);
+}
 
-    SDL_Color textColor = {0, 0, 0, 255};
+void draw_credits_screen(SDL_Renderer* renderer,
+                         TTF_Font* titleFont,
+                         TTF_Font* smallFont,
+                         TTF_Font* buttonFont)
+{
+    queueBackground(optionBackground);
+    queueTitle(renderer, titleFont, "Credits");
 
-    SDL_Surface* titleSurf = TTF_RenderText_Solid(titleFont, "Options", textColor);
-    if (titleSurf) {
-        SDL_Texture* titleTex = SDL_CreateTextureFromSurface(renderer, titleSurf);
-        SDL_Rect titleRect = { (WINDOW_WIDTH - titleSurf->w) / 2, 20, titleSurf->w, titleSurf->h };
-        SDL_FreeSurface(titleSurf);
-        SDL_RenderCopy(renderer, titleTex, NULL, &titleRect);
-        SDL_DestroyTexture(titleTex);
+    if (!creditsPage.texture)
+        buildCreditsPage(renderer, smallFont);
+    if (creditsPage.texture) {
+        SDL_Rect pageRect = { 0, 120, creditsPage.width, creditsPage.height };
+        queueCopy(LAYER_PANEL, creditsPage.texture, nullptr, pageRect);
     }
 
-    const int CLOUD_BTN_WIDTH = 220;
-    const int CLOUD_BTN_HEIGHT = 70;
-    const int spacing = 20;
-    int startY = 120;
-
-    SDL_Rect helpBtn = { (WINDOW_WIDTH - CLOUD_BTN_WIDTH) / 2, startY, CLOUD_BTN_WIDTH, CLOUD_BTN_HEIGHT };
-    SDL_Rect restartBtn = { (WINDOW_WIDTH - CLOUD_BTN_WIDTH) / 2, startY + CLOUD_BTN_HEIGHT + spacing, CLOUD_BTN_WIDTH, CLOUD_BTN_HEIGHT };
-    SDL_Rect creditBtn = { (WINDOW_WIDTH - CLOUD_BTN_WIDTH) / 2, startY + 2 * (CLOUD_BTN_HEIGHT + spacing), CLOUD_BTN_WIDTH, CLOUD_BTN_HEIGHT };
-    SDL_Rect optionQuitBtn = { (WINDOW_WIDTH - CLOUD_BTN_WIDTH) / 2, startY + 3 * (CLOUD_BTN_HEIGHT + spacing), CLOUD_BTN_WIDTH, CLOUD_BTN_HEIGHT };
-
-    SDL_Rect backBtn = { WINDOW_WIDTH - CLOUD_BTN_WIDTH - 20, WINDOW_HEIGHT - CLOUD_BTN_HEIGHT - 20, CLOUD_BTN_WIDTH, CLOUD_BTN_HEIGHT };
-
-    auto drawCloudButton = [&](SDL_Rect btnRect, const char* text) {
-        drawCloudButtonWithText(renderer, cloudTexture, btnRect, text, buttonFont);
-    };
-
-    drawCloudButton(helpBtn, "Help");
-    drawCloudButton(restartBtn, "Restart");
-    drawCloudButton(creditBtn, "Credits");
-    drawCloudButton(optionQuitBtn, "Quit");
-
-    const int sliderWidth = 300;
-    const int sliderHeight = 20;
-    const int toggleSize = sliderHeight + 10;
-
-    int musicSliderY = startY + 4 * (CLOUD_BTN_HEIGHT + spacing) + 30;
-    SDL_Rect musicSliderBg = { (WINDOW_WIDTH - sliderWidth) / 2, musicSliderY, sliderWidth, sliderHeight };
+    drawUiButtons(renderer, UI_SCREEN_CREDITS, buttonFont);
 
-    int sfxSliderY = musicSliderY + 60;
-    SDL_Rect sfxSliderBg = { (WINDOW_WIDTH - sliderWidth) / 2, sfxSliderY, sliderWidth, sliderHeight };
+    presentFrame(renderer);
+}
 
+// A volume slider: the track, its knob at value out of maxValue and a label
+// above it.
+static void queueSlider(SDL_Renderer* renderer, TTF_Font* font, const char* label,
+                        const SDL_Rect& track, int value, int maxValue)
+{
+    const int toggleSize = UI_SLIDER_TOGGLE_SIZE;
     if (musicbarTexture) {
-        SDL_RenderCopy(renderer, musicbarTexture, NULL, &musicSliderBg);
+        queueCopy(LAYER_CONTROL, musicbarTexture, nullptr, track);
     } else {
-        SDL_SetRenderDrawColor(renderer, 180, 180, 180, 255);
-        SDL_RenderFillRect(renderer, &musicSliderBg);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderDrawRect(renderer, &musicSliderBg);
+        queueFill(LAYER_CONTROL, { 180, 180, 180, 255 }, track);
+        queueOutline(LAYER_CONTROL, { 0, 0, 0, 255 }, track);
     }
-    int sliderX = musicSliderBg.x;
-    int musicToggleX = sliderX + (musicVolume * (sliderWidth - toggleSize)) / DEFAULT_VOLUME;
-    SDL_Rect musicToggleRect = { musicToggleX, musicSliderY - 5, toggleSize, toggleSize };
+    int toggleX = track.x + (value * (track.w - toggleSize)) / maxValue;
+    SDL_Rect toggleRect = { toggleX, track.y - 5, toggleSize, toggleSize };
     if (musictoggleTexture) {
-        SDL_RenderCopy(renderer, musictoggleTexture, NULL, &musicToggleRect);
+        queueCopy(LAYER_CONTROL_TOP, musictoggleTexture, nullptr, toggleRect);
     } else {
-        SDL_SetRenderDrawColor(renderer, 100, 100, 250, 255);
-        SDL_RenderFillRect(renderer, &musicToggleRect);
+        queueFill(LAYER_CONTROL_TOP, { 100, 100, 250, 255 }, toggleRect);
     }
 
-    SDL_Surface* musicLabelSurf = TTF_RenderText_Solid(buttonFont, "Music", textColor);
-    if (musicLabelSurf) {
-        SDL_Texture* musicLabelTex = SDL_CreateTextureFromSurface(renderer, musicLabelSurf);
-        SDL_Rect musicLabelRect = {
-            sliderX + (sliderWidth - musicLabelSurf->w) / 2,
-            musicSliderY - 35,
-            musicLabelSurf->w,
-            musicLabelSurf->h
-        };
-        SDL_FreeSurface(musicLabelSurf);
-        SDL_RenderCopy(renderer, musicLabelTex, NULL, &musicLabelRect);
-        SDL_DestroyTexture(musicLabelTex);
-    }
+    FrameText text = frameText(renderer, font, label, {0, 0, 0, 255});
+    queueText(LAYER_TEXT, text, track.x + (track.w - text.w) / 2, track.y - 35);
+}
 
-    if (musicbarTexture) {
-        SDL_RenderCopy(renderer, musicbarTexture, NULL, &sfxSliderBg);
-    } else {
-        SDL_SetRenderDrawColor(renderer, 180, 180, 180, 255);
-        SDL_RenderFillRect(renderer, &sfxSliderBg);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderDrawRect(renderer, &sfxSliderBg);
+void draw_options_screen(SDL_Renderer* renderer,
+                         TTF_Font* buttonFont,
+                         TTF_Font* titleFont)
+{
+    queueBackground(optionBackground);
+    queueTitle(renderer, titleFont, "Options");
+
+    drawUiButtons(renderer, UI_SCREEN_OPTIONS, buttonFont);
+
+    queueSlider(renderer, buttonFont, "Music", uiRect(UI_SCREEN_OPTIONS, WIDGET_MUSIC_SLIDER),
+                musicVolume, DEFAULT_VOLUME);
+    queueSlider(renderer, buttonFont, "SFX", uiRect(UI_SCREEN_OPTIONS, WIDGET_SFX_SLIDER),
+                sfxVolume, DEFAULT_SFX_VOLUME);
+
+    presentFrame(renderer);
+}
+
+// Lines from the game history under the game over buttons.
+static void drawHistorySummary(SDL_Renderer* renderer, TTF_Font* font, const SDL_Rect& above)
+{
+    HistorySummary summary;
+    if (!historySummary(&summary) || summary.games == 0)
+        return;
+
+    std::vector<std::string> lines;
+    lines.push_back("Games played: " + std::to_string(summary.games)
+                    + "   Median: " + std::to_string(summary.medianScore)
+                    + "   Top 10%: " + std::to_string(summary.p90Score));
+    std::string top = "Best scores:";
+    for (int i = 0; i < summary.topCount; i++) {
+        top += "  " + std::to_string(summary.topScores[i]);
     }
-    int sfxToggleX = sfxSliderBg.x + (sfxVolume * (sliderWidth - toggleSize)) / DEFAULT_SFX_VOLUME;
-    SDL_Rect sfxToggleRect = { sfxToggleX, sfxSliderBg.y - 5, toggleSize, toggleSize };
-    if (musictoggleTexture) {
-        SDL_RenderCopy(renderer, musictoggleTexture, NULL, &sfxToggleRect);
-    } else {
-        SDL_SetRenderDrawColor(renderer, 100, 100, 250, 255);
-        SDL_RenderFillRect(renderer, &sfxToggleRect);
+    lines.push_back(top);
+    std::string trend = "This game beat " + std::to_string(summary.lastBeatPercent) + "% of your games";
+    if (summary.previousAverage > 0.0) {
+        int change = (int)((summary.recentAverage / summary.previousAverage - 1.0) * 100.0);
+        trend += ", recent form " + std::string(change >= 0 ? "+" : "") + std::to_string(change) + "%";
     }
+    lines.push_back(trend);
 
-    SDL_Surface* sfxLabelSurf = TTF_RenderText_Solid(buttonFont, "SFX", textColor);
-    if (sfxLabelSurf) {
-        SDL_Texture* sfxLabelTex = SDL_CreateTextureFromSurface(renderer, sfxLabelSurf);
-        SDL_Rect sfxLabelRect = {
-            sfxSliderBg.x + (sliderWidth - sfxLabelSurf->w) / 2,
-            sfxSliderBg.y - 35,
-            sfxLabelSurf->w,
-            sfxLabelSurf->h
-        };
-        SDL_FreeSurface(sfxLabelSurf);
-        SDL_RenderCopy(renderer, sfxLabelTex, NULL, &sfxLabelRect);
-        SDL_DestroyTexture(sfxLabelTex);
+    SDL_Color textColor = {0, 0, 0, 255};
+    int y = above.y + above.h + 20;
+    for (const std::string& line : lines) {
+        FrameText text = frameText(renderer, font, line.c_str(), textColor, true);
+        if (!text.texture)
+            continue;
+        queueText(LAYER_TEXT, text, (WINDOW_WIDTH - text.w) / 2, y);
+        y += TTF_FontLineSkip(font);
     }
+}
 
-    drawCloudButton(backBtn, "Back");
-
-    SDL_RenderPresent(renderer);
+// The heading and the line under it on the end screens.
+static void queueEndScreenText(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont,
+                               const char* heading, const std::string& line)
+{
+    SDL_Color textColor = {0, 0, 0, 255};
+    FrameText headingText = frameText(renderer, titleFont, heading, textColor);
+    int headingY = (WINDOW_HEIGHT / 4) - (headingText.h / 2);
+    queueText(LAYER_TEXT, headingText, (WINDOW_WIDTH - headingText.w) / 2, headingY);
+    FrameText lineText = frameText(renderer, smallFont, line.c_str(), textColor);
+    queueText(LAYER_TEXT, lineText, (WINDOW_WIDTH - lineText.w) / 2, headingY + headingText.h + 10);
 }
 
 void draw_game_over_screen(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont)
 {
-    SDL_SetRenderDrawColor(renderer, 187, 173, 160, 255);
-    SDL_RenderClear(renderer);
-
-    if (optionBackground) {
-        SDL_Rect bgRect = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
-        SDL_RenderCopy(renderer, optionBackground, NULL, &bgRect);
-    }
+    queueClear({ 187, 173, 160, 255 });
+    queueBackground(optionBackground);
 
-    if (currentGameoverIndex != 0 && gameoverTextures.count(currentGameoverIndex)) {
+    SDL_Texture* sideTexture = gameoverTextures.count(currentGameoverIndex)
+        ? useTexture(gameoverTextures[currentGameoverIndex]) : nullptr;
+    if (sideTexture) {
         SDL_Rect sideRect;
         sideRect.w = WINDOW_WIDTH / 4;
         sideRect.h = WINDOW_HEIGHT / 3 + 50;
         sideRect.x = WINDOW_WIDTH - sideRect.w - 50;
         sideRect.y = WINDOW_HEIGHT / 3 - 20;
-        SDL_RenderCopy(renderer, gameoverTextures[currentGameoverIndex], nullptr, &sideRect);
+        queueCopy(LAYER_DECOR, sideTexture, nullptr, sideRect);
     }
 
-    SDL_Color textColor = {0, 0, 0, 255};
-    SDL_Surface* gameOverSurface = TTF_RenderText_Solid(titleFont, "Game Over!", textColor);
-    SDL_Texture* gameOverTexture = SDL_CreateTextureFromSurface(renderer, gameOverSurface);
-    SDL_Rect gameOverRect = {
-        (WINDOW_WIDTH - gameOverSurface->w) / 2,
-        (WINDOW_HEIGHT / 4) - (gameOverSurface->h / 2),
-        gameOverSurface->w,
-        gameOverSurface->h
-    };
-    SDL_FreeSurface(gameOverSurface);
-    SDL_RenderCopy(renderer, gameOverTexture, NULL, &gameOverRect);
-    SDL_DestroyTexture(gameOverTexture);
-
-    std::string resultText = "Your Score: " + std::to_string(score);
-    SDL_Surface* resultSurface = TTF_RenderText_Solid(smallFont, resultText.c_str(), textColor);
-    SDL_Texture* resultTexture = SDL_CreateTextureFromSurface(renderer, resultSurface);
-    SDL_Rect resultRect = {
-        (WINDOW_WIDTH - resultSurface->w) / 2,
-        gameOverRect.y + gameOverRect.h + 10,
-        resultSurface->w,
-        resultSurface->h
-    };
-    SDL_FreeSurface(resultSurface);
-    SDL_RenderCopy(renderer, resultTexture, NULL, &resultRect);
-    SDL_DestroyTexture(resultTexture);
+    queueEndScreenText(renderer, titleFont, smallFont, "Game Over!", "Your Score: " + std::to_string(score));
 
-    const int btnWidth = 200, btnHeight = 60, spacing = 20;
-    int btnStartY = resultRect.y + resultRect.h + 30;
-    SDL_Rect restartBtn = { (WINDOW_WIDTH - btnWidth) / 2, btnStartY, btnWidth, btnHeight };
-    SDL_Rect quitBtn = { (WINDOW_WIDTH - btnWidth) / 2, btnStartY + btnHeight + spacing, btnWidth, btnHeight };
+    drawUiButtons(renderer, UI_SCREEN_GAMEOVER, smallFont);
+    drawHistorySummary(renderer, smallFont, uiRect(UI_SCREEN_GAMEOVER, WIDGET_QUIT));
 
-    drawCloudButtonWithText(renderer, cloudTexture, restartBtn, "Restart", smallFont);
-    drawCloudButtonWithText(renderer, cloudTexture, quitBtn, "Quit", smallFont);
-
-    SDL_RenderPresent(renderer);
+    presentFrame(renderer);
 }
 
 
 void draw_win_screen(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont)
 {
-    SDL_SetRenderDrawColor(renderer, 187, 173, 160, 255);
-    SDL_RenderClear(renderer);
+    queueClear({ 187, 173, 160, 255 });
+    queueBackground(gamewonBackground ? gamewonBackground : optionBackground);
 
-    if (gamewonBackground) {
-        SDL_Rect bgRect = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
-        SDL_RenderCopy(renderer, gamewonBackground, NULL, &bgRect);
-    }
-    else if (optionBackground) {
-        SDL_Rect bgRect = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
-        SDL_RenderCopy(renderer, optionBackground, NULL, &bgRect);
-    }
-
-    if (!gamewinTextures.empty()) {
+    SDL_Texture* sideTexture = gamewinTextures.count(currentWinIndex)
+        ? useTexture(gamewinTextures[currentWinIndex]) : nullptr;
+    if (sideTexture) {
         SDL_Rect sideRect;
         sideRect.w = WINDOW_WIDTH / 4;
         sideRect.h = WINDOW_HEIGHT / 3;
         sideRect.x = WINDOW_WIDTH - sideRect.w - 50;
         sideRect.y = WINDOW_HEIGHT / 3;
-        if (gamewinTextures.count(currentWinIndex))
-            SDL_RenderCopy(renderer, gamewinTextures[currentWinIndex], NULL, &sideRect);
+        queueCopy(LAYER_DECOR, sideTexture, nullptr, sideRect);
     }
 
-    SDL_Color textColor = {0, 0, 0, 255};
-    SDL_Surface* winSurface = TTF_RenderText_Solid(titleFont, "Congratulations!", textColor);
-    SDL_Texture* winTexture = SDL_CreateTextureFromSurface(renderer, winSurface);
-    SDL_Rect winRect = {
-        (WINDOW_WIDTH - winSurface->w) / 2,
-        (WINDOW_HEIGHT / 4) - (winSurface->h / 2),
-        winSurface->w,
-        winSurface->h
-    };
-    SDL_FreeSurface(winSurface);
-    SDL_RenderCopy(renderer, winTexture, NULL, &winRect);
-    SDL_DestroyTexture(winTexture);
-
-    std::string winLine = "You reached 2048!";
-    SDL_Surface* winLineSurf = TTF_RenderText_Solid(smallFont, winLine.c_str(), textColor);
-    SDL_Texture* winLineTex = SDL_CreateTextureFromSurface(renderer, winLineSurf);
-    SDL_Rect winLineRect = {
-        (WINDOW_WIDTH - winLineSurf->w) / 2,
-        winRect.y + winRect.h + 10,
-        winLineSurf->w,
-        winLineSurf->h
-    };
-    SDL_FreeSurface(winLineSurf);
-    SDL_RenderCopy(renderer, winLineTex, NULL, &winLineRect);
-    SDL_DestroyTexture(winLineTex);
-
-    const int btnWidth = 250, btnHeight = 70, spacing = 20;
-    int btnStartY = winLineRect.y + winLineRect.h + 30;
-    SDL_Rect continueBtn = { (WINDOW_WIDTH - btnWidth) / 2, btnStartY, btnWidth, btnHeight };
-    SDL_Rect quitBtn     = { (WINDOW_WIDTH - btnWidth) / 2, btnStartY + (btnHeight + spacing), btnWidth, btnHeight };
+    queueEndScreenText(renderer, titleFont, smallFont, "Congratulations!", "You reached 2048!");
 
-    drawCloudButtonWithText(renderer, cloudTexture, continueBtn, "Continue", smallFont);
-    drawCloudButtonWithText(renderer, cloudTexture, quitBtn, "Quit", smallFont);
+    drawUiButtons(renderer, UI_SCREEN_WIN, smallFont);
 
-    SDL_RenderPresent(renderer);
+    presentFrame(renderer);
 }
 
 void drawCloudButtonWithText(SDL_Renderer* renderer, SDL_Texture* cloudTex, const SDL_Rect &btnRect, const char* text, TTF_Font* font) {
     if (cloudTex) {
-        SDL_RenderCopy(renderer, cloudTex, NULL, &btnRect);
+        queueCopy(LAYER_CONTROL, cloudTex, nullptr, btnRect);
     } else {
-        SDL_SetRenderDrawColor(renderer, 250, 100, 100, 255);
-        SDL_RenderFillRect(renderer, &btnRect);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderDrawRect(renderer, &btnRect);
-    }
-    SDL_Color blackColor = {0, 0, 0, 255};
-    SDL_Surface* textSurf = TTF_RenderText_Solid(font, text, blackColor);
-    if (textSurf) {
-        SDL_Texture* textTex = SDL_CreateTextureFromSurface(renderer, textSurf);
-        SDL_Rect textRect = {
-            btnRect.x + (btnRect.w - textSurf->w) / 2,
-            btnRect.y + (btnRect.h - textSurf->h) / 2,
-            textSurf->w,
-            textSurf->h
-        };
-        SDL_FreeSurface(textSurf);
-        SDL_RenderCopy(renderer, textTex, NULL, &textRect);
-        SDL_DestroyTexture(textTex);
+        queueFill(LAYER_CONTROL, { 250, 100, 100, 255 }, btnRect);
+        queueOutline(LAYER_CONTROL, { 0, 0, 0, 255 }, btnRect);
     }
+    queueCenteredText(frameText(renderer, font, text, {0, 0, 0, 255}), btnRect);
 }
-
-
@@ -4,14 +4,30 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 
+// Initial help scroll speed per key press / wheel notch, in pixels per second.
+const float HELP_SCROLL_IMPULSE = 900.0f;
+// Fraction of scroll velocity left after one second of coasting.
+const float HELP_SCROLL_FRICTION = 0.02f;
+
 void recomputeLayout(SDL_Window* window);
 
+// Drops the cached help/credits pages so they are re-rendered on next draw.
+void invalidateTextPages();
+
+void freeTextPages();
+
+// Release one cached page; it is rebuilt the next time it is drawn.
+void freeHelpPage();
+void freeCreditsPage();
+
 void draw_start_screen(SDL_Renderer* renderer);
 
 void draw_sidebar(SDL_Renderer* renderer, TTF_Font* valueFont, TTF_Font* smallFont);
 
 void draw_grid(SDL_Renderer* renderer, TTF_Font* font);
 
+void draw_marathon_screen(SDL_Renderer* renderer, TTF_Font* font);
+
 void draw_help_screen(SDL_Renderer* renderer, TTF_Font* titleFont, TTF_Font* smallFont);
 
 void draw_credits_screen(SDL_Renderer* renderer,
@@ -0,0 +1,287 @@
+#include "history.h"
+#include "globals.h"
+#include "mapped.h"
+#include "persistence.h"
+#include "log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+const char HISTORY_MAGIC[8] = { '2', '0', '4', '8', 'H', 'I', 'S', '\0' };
+const Uint32 HISTORY_VERSION = 1;
+
+struct HistoryHeader {
+    char magic[8];
+    Uint32 version;
+    Uint32 blockRecords;
+};
+
+// Padded so the columns after it start cache-line aligned.
+struct HistoryBlockHeader {
+    Uint32 count;
+    Uint32 reserved[15];
+};
+
+const size_t HISTORY_BLOCK_BYTES =
+    sizeof(HistoryBlockHeader) + sizeof(Uint32) * HISTORY_COLUMN_COUNT * HISTORY_BLOCK_RECORDS;
+
+GameRecord currentGameStats;
+static Uint32 gameStartTime = 0;
+
+// Written by the persistence thread, read by the game.
+static SDL_SpinLock summaryLock = 0;
+static HistorySummary publishedSummary;
+static bool summaryReady = false;
+
+void historyBeginGame(Uint32 seed)
+{
+    currentGameStats = GameRecord();
+    currentGameStats.values[HISTORY_SEED] = seed;
+    gameStartTime = SDL_GetTicks();
+}
+
+Uint32 historyElapsedMs()
+{
+    return SDL_GetTicks() - gameStartTime;
+}
+
+void historySetElapsedMs(Uint32 elapsed)
+{
+    gameStartTime = SDL_GetTicks() - elapsed;
+}
+
+// A view of one block of the mapped file.
+struct BlockView {
+    Uint32 count;
+    const Uint32* columns;
+
+    const Uint32* column(int c) const { return columns + (size_t)c * HISTORY_BLOCK_RECORDS; }
+};
+
+static std::vector<BlockView> blockViews(const MappedFile& file)
+{
+    std::vector<BlockView> blocks;
+    const HistoryHeader* header = (const HistoryHeader*)file.data;
+    if (file.size < sizeof(HistoryHeader)
+        || std::memcmp(header->magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) != 0
+        || header->version != HISTORY_VERSION || header->blockRecords != HISTORY_BLOCK_RECORDS)
+        return blocks;
+    for (size_t offset = sizeof(HistoryHeader); offset + HISTORY_BLOCK_BYTES <= file.size; offset += HISTORY_BLOCK_BYTES) {
+        const HistoryBlockHeader* block = (const HistoryBlockHeader*)(file.data + offset);
+        BlockView view = { std::min(block->count, HISTORY_BLOCK_RECORDS),
+                           (const Uint32*)(file.data + offset + sizeof(HistoryBlockHeader)) };
+        blocks.push_back(view);
+    }
+    return blocks;
+}
+
+// Plain loops over one column; these vectorize.
+static Uint64 sumRange(const Uint32* values, Uint32 count)
+{
+    Uint64 sum = 0;
+    for (Uint32 i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+static Uint32 maxRange(const Uint32* values, Uint32 count)
+{
+    Uint32 best = 0;
+    for (Uint32 i = 0; i < count; i++) {
+        best = values[i] > best ? values[i] : best;
+    }
+    return best;
+}
+
+static Uint32 countBelow(const Uint32* values, Uint32 count, Uint32 limit)
+{
+    Uint32 below = 0;
+    for (Uint32 i = 0; i < count; i++) {
+        below += values[i] < limit;
+    }
+    return below;
+}
+
+// Sum of column c over games [from, to) across blocks.
+static Uint64 sumGames(const std::vector<BlockView>& blocks, int c, Uint32 from, Uint32 to)
+{
+    Uint64 sum = 0;
+    Uint32 start = 0;
+    for (const BlockView& block : blocks) {
+        Uint32 lo = std::max(from, start), hi = std::min(to, start + block.count);
+        if (lo < hi)
+            sum += sumRange(block.column(c) + (lo - start), hi - lo);
+        start += block.count;
+    }
+    return sum;
+}
+
+static HistorySummary summarize(const std::vector<BlockView>& blocks)
+{
+    HistorySummary s = HistorySummary();
+    std::vector<Uint32> scores;
+    Uint32 lastScore = 0;
+    for (const BlockView& block : blocks) {
+        const Uint32* column = block.column(HISTORY_SCORE);
+        s.bestTile = std::max(s.bestTile, maxRange(block.column(HISTORY_MAX_TILE), block.count));
+        scores.insert(scores.end(), column, column + block.count);
+        if (block.count)
+            lastScore = column[block.count - 1];
+    }
+    s.games = (Uint32)scores.size();
+    if (s.games == 0)
+        return s;
+
+    Uint32 below = 0;
+    for (const BlockView& block : blocks) {
+        below += countBelow(block.column(HISTORY_SCORE), block.count, lastScore);
+    }
+    s.lastBeatPercent = s.games > 1 ? below * 100 / (s.games - 1) : 100;
+
+    Uint32 window = std::min(HISTORY_TREND_WINDOW, s.games);
+    s.recentAverage = (double)sumGames(blocks, HISTORY_SCORE, s.games - window, s.games) / window;
+    if (s.games >= 2 * HISTORY_TREND_WINDOW) {
+        Uint32 from = s.games - 2 * HISTORY_TREND_WINDOW;
+        s.previousAverage = (double)sumGames(blocks, HISTORY_SCORE, from, from + HISTORY_TREND_WINDOW) / HISTORY_TREND_WINDOW;
+    }
+
+    s.topCount = std::min((int)s.games, HISTORY_TOP_N);
+    std::partial_sort(scores.begin(), scores.begin() + s.topCount, scores.end(), std::greater<Uint32>());
+    std::copy(scores.begin(), scores.begin() + s.topCount, s.topScores);
+    // Ranks counted from the top, so the already sorted prefix is left alone.
+    size_t median = scores.size() / 2, p90 = scores.size() / 10;
+    std::nth_element(scores.begin(), scores.begin() + median, scores.end(), std::greater<Uint32>());
+    s.medianScore = scores[median];
+    std::nth_element(scores.begin(), scores.begin() + p90, scores.end(), std::greater<Uint32>());
+    s.p90Score = scores[p90];
+    return s;
+}
+
+static void publishSummary()
+{
+    MappedFile file;
+    HistorySummary summary = HistorySummary();
+    if (mapFile(HISTORY_PATH, file)) {
+        summary = summarize(blockViews(file));
+        unmapFile(file);
+    }
+    SDL_AtomicLock(&summaryLock);
+    publishedSummary = summary;
+    summaryReady = true;
+    SDL_AtomicUnlock(&summaryLock);
+}
+
+static bool writeAt(FILE* file, long offset, const void* data, size_t size)
+{
+    return std::fseek(file, offset, SEEK_SET) == 0 && std::fwrite(data, size, 1, file) == 1;
+}
+
+static void syncFile(FILE* file)
+{
+    std::fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+// Column values go down first and the block count last, each synced, so a
+// crash can only lose the record being appended.
+static void appendRecord(const GameRecord& record)
+{
+    FILE* file = std::fopen(HISTORY_PATH, "r+b");
+    if (!file) {
+        file = std::fopen(HISTORY_PATH, "w+b");
+        HistoryHeader header = {};
+        std::memcpy(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+        header.version = HISTORY_VERSION;
+        header.blockRecords = HISTORY_BLOCK_RECORDS;
+        if (!file || !writeAt(file, 0, &header, sizeof(header))) {
+            LOG_ERROR(LOG_SAVE, "Cannot create %s", HISTORY_PATH);
+            if (file) std::fclose(file);
+            return;
+        }
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    long blocks = (size - (long)sizeof(HistoryHeader)) / (long)HISTORY_BLOCK_BYTES;
+    HistoryBlockHeader block = {};
+    long blockOffset = (long)sizeof(HistoryHeader) + (blocks - 1) * (long)HISTORY_BLOCK_BYTES;
+    if (blocks > 0) {
+        std::fseek(file, blockOffset, SEEK_SET);
+        if (std::fread(&block, sizeof(block), 1, file) != 1)
+            block.count = HISTORY_BLOCK_RECORDS;
+    }
+    if (blocks == 0 || block.count >= HISTORY_BLOCK_RECORDS) {
+        // Start a new block at its full size so the columns never move.
+        static const std::vector<char> zeros(HISTORY_BLOCK_BYTES, 0);
+        blockOffset = (long)sizeof(HistoryHeader) + blocks * (long)HISTORY_BLOCK_BYTES;
+        block = HistoryBlockHeader();
+        if (!writeAt(file, blockOffset, zeros.data(), zeros.size())) {
+            LOG_ERROR(LOG_SAVE, "Cannot grow %s", HISTORY_PATH);
+            std::fclose(file);
+            return;
+        }
+    }
+
+    long columnsOffset = blockOffset + (long)sizeof(HistoryBlockHeader);
+    bool ok = true;
+    for (int c = 0; c < HISTORY_COLUMN_COUNT && ok; c++) {
+        long offset = columnsOffset + (long)((c * HISTORY_BLOCK_RECORDS + block.count) * sizeof(Uint32));
+        ok = writeAt(file, offset, &record.values[c], sizeof(Uint32));
+    }
+    if (ok) {
+        syncFile(file);
+        block.count++;
+        ok = writeAt(file, blockOffset, &block, sizeof(block));
+        syncFile(file);
+    }
+    if (!ok)
+        LOG_ERROR(LOG_SAVE, "Failed to append to %s", HISTORY_PATH);
+    std::fclose(file);
+}
+
+void historyFinishGame()
+{
+    Uint32 maxTile = 0;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            if (grid[i][j] > 0 && (Uint32)grid[i][j] > maxTile)
+                maxTile = grid[i][j];
+        }
+    }
+    currentGameStats.values[HISTORY_SCORE] = score > 0 ? score : 0;
+    currentGameStats.values[HISTORY_MAX_TILE] = maxTile;
+    currentGameStats.values[HISTORY_DURATION_MS] = historyElapsedMs();
+
+    GameRecord record = currentGameStats;
+    queuePersistTask([record]() {
+        appendRecord(record);
+        publishSummary();
+    });
+}
+
+void refreshHistorySummary()
+{
+    queuePersistTask(publishSummary);
+}
+
+bool historySummary(HistorySummary* out)
+{
+    SDL_AtomicLock(&summaryLock);
+    bool ready = summaryReady;
+    if (ready)
+        *out = publishedSummary;
+    SDL_AtomicUnlock(&summaryLock);
+    return ready;
+}
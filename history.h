@@ -0,0 +1,71 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <SDL.h>
+
+// Local history of finished games, one fixed-size record per game, stored
+// column by column in blocks of HISTORY_BLOCK_RECORDS so aggregates are
+// straight scans over contiguous arrays of the memory-mapped file:
+//
+//   HistoryHeader
+//   block: HistoryBlockHeader, then Uint32 column[HISTORY_COLUMN_COUNT][HISTORY_BLOCK_RECORDS]
+//
+// Appends and queries run on the persistence thread; the game only reads the
+// summary that the last query published.
+
+const char* const HISTORY_PATH = "assets/text/history.dat";
+const Uint32 HISTORY_BLOCK_RECORDS = 4096;
+const int HISTORY_TOP_N = 5;
+// Games per side when comparing recent form with the games before it.
+const Uint32 HISTORY_TREND_WINDOW = 20;
+
+enum HistoryColumn {
+    HISTORY_SEED,
+    HISTORY_SCORE,
+    HISTORY_MAX_TILE,
+    HISTORY_MOVES,
+    HISTORY_DURATION_MS,
+    HISTORY_BOOSTER_USES,
+    HISTORY_BLOCKERS,
+    HISTORY_COLUMN_COUNT
+};
+
+struct GameRecord {
+    Uint32 values[HISTORY_COLUMN_COUNT];
+};
+
+struct HistorySummary {
+    Uint32 games;
+    Uint32 topScores[HISTORY_TOP_N];
+    int topCount;
+    Uint32 medianScore;
+    Uint32 p90Score;
+    Uint32 bestTile;
+    // Share of earlier games the most recent one beat, 0..100.
+    Uint32 lastBeatPercent;
+    // Average score of the last HISTORY_TREND_WINDOW games and of the window
+    // before it; previousAverage is 0 until there are enough games.
+    double recentAverage;
+    double previousAverage;
+};
+
+// Stats of the game being played, counted as it goes.
+extern GameRecord currentGameStats;
+
+// Resets the counters for a new game dealt from seed.
+void historyBeginGame(Uint32 seed);
+
+// Milliseconds of play so far; saved games store this instead of a tick count.
+Uint32 historyElapsedMs();
+void historySetElapsedMs(Uint32 elapsed);
+
+// Completes the record from the final board and queues the append.
+void historyFinishGame();
+
+// Queues a summary refresh, e.g. at startup.
+void refreshHistorySummary();
+
+// Copies the latest published summary. False if there is none yet.
+bool historySummary(HistorySummary* out);
+
+#endif // HISTORY_H
@@ -0,0 +1,69 @@
+#include "input.h"
+#include "game.h"
+#include "latency.h"
+#include "log.h"
+
+static MoveInput queue[MAX_INPUT_QUEUE_DEPTH];
+static int queueHead = 0;
+static int queueCount = 0;
+static int queueDepth = DEFAULT_INPUT_QUEUE_DEPTH;
+
+void setInputQueueDepth(int depth)
+{
+    clearMoveInputs();
+    queueDepth = SDL_clamp(depth, 1, MAX_INPUT_QUEUE_DEPTH);
+}
+
+bool isMoveKey(SDL_Keycode key)
+{
+    return key == SDLK_UP || key == SDLK_DOWN || key == SDLK_LEFT || key == SDLK_RIGHT;
+}
+
+bool queueMoveInput(const SDL_KeyboardEvent& key)
+{
+    if (key.repeat && queueCount > 0) {
+        return false;
+    }
+    if (queueCount == queueDepth) {
+        LOG_DEBUG(LOG_INPUT, "Input queue full, dropped %s", SDL_GetKeyName(key.keysym.sym));
+        return false;
+    }
+    MoveInput& slot = queue[(queueHead + queueCount) % MAX_INPUT_QUEUE_DEPTH];
+    slot.key = key.keysym.sym;
+    slot.timestamp = key.timestamp;
+    queueCount++;
+    return true;
+}
+
+bool takeMoveInput(MoveInput& input)
+{
+    if (queueCount == 0)
+        return false;
+    input = queue[queueHead];
+    queueHead = (queueHead + 1) % MAX_INPUT_QUEUE_DEPTH;
+    queueCount--;
+    return true;
+}
+
+int pendingMoveInputs()
+{
+    return queueCount;
+}
+
+void clearMoveInputs()
+{
+    queueHead = 0;
+    queueCount = 0;
+}
+
+bool applyQueuedMove()
+{
+    MoveInput input;
+    if (!takeMoveInput(input))
+        return false;
+    LOG_TRACE(LOG_INPUT, "Applying %s, queued %u ms", SDL_GetKeyName(input.key),
+              SDL_GetTicks() - input.timestamp);
+    move_tiles(input.key);
+    markInputHandled(input.timestamp);
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL.h>
+
+// Buffered move input. Arrow presses are queued with their event timestamp
+// and applied one per frame, so every move gets its own rendered frame and
+// presses that arrive faster than that are kept instead of lost.
+
+const int DEFAULT_INPUT_QUEUE_DEPTH = 3;
+const int MAX_INPUT_QUEUE_DEPTH = 8;
+
+struct MoveInput {
+    SDL_Keycode key;
+    Uint32 timestamp;   // SDL event time of the press.
+};
+
+// How many moves may wait; clamped to 1..MAX_INPUT_QUEUE_DEPTH.
+void setInputQueueDepth(int depth);
+
+bool isMoveKey(SDL_Keycode key);
+
+// Queues an arrow press. Key repeats are only taken while nothing else is
+// waiting, so holding a key never builds a backlog that outlives the key.
+// Returns false if the press was dropped.
+bool queueMoveInput(const SDL_KeyboardEvent& key);
+
+bool takeMoveInput(MoveInput& input);
+
+int pendingMoveInputs();
+
+// Drops everything waiting, e.g. when a menu opens or the game ends.
+void clearMoveInputs();
+
+// Plays the oldest buffered move on the board. Returns whether there was one.
+bool applyQueuedMove();
+
+#endif // INPUT_H
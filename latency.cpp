@@ -0,0 +1,50 @@
+#include "latency.h"
+#include "log.h"
+#include <algorithm>
+#include <vector>
+
+// Inputs handled since the last present. A click drains the move buffer, so
+// a frame can carry a few of them.
+static const int MAX_OPEN_TAGS = 16;
+static Uint32 openTags[MAX_OPEN_TAGS];
+static int openTagCount = 0;
+
+static Uint32 samples[LATENCY_WINDOW];
+static int sampleCount = 0;
+static int nextSample = 0;
+
+void markInputHandled(Uint32 eventTimestamp)
+{
+    if (openTagCount < MAX_OPEN_TAGS)
+        openTags[openTagCount++] = eventTimestamp;
+}
+
+void markFramePresented()
+{
+    if (openTagCount == 0)
+        return;
+    Uint32 now = SDL_GetTicks();
+    for (int i = 0; i < openTagCount; i++) {
+        samples[nextSample] = now - openTags[i];
+        nextSample = (nextSample + 1) % LATENCY_WINDOW;
+        sampleCount = std::min(sampleCount + 1, LATENCY_WINDOW);
+        if (nextSample == 0) {
+            Uint32 p50, p95, p99;
+            inputLatencyPercentiles(&p50, &p95, &p99);
+            LOG_DEBUG(LOG_INPUT, "Input latency p50 %u ms, p95 %u ms, p99 %u ms", p50, p95, p99);
+        }
+    }
+    openTagCount = 0;
+}
+
+bool inputLatencyPercentiles(Uint32* p50, Uint32* p95, Uint32* p99)
+{
+    if (sampleCount == 0)
+        return false;
+    std::vector<Uint32> sorted(samples, samples + sampleCount);
+    std::sort(sorted.begin(), sorted.end());
+    *p50 = sorted[(sampleCount - 1) * 50 / 100];
+    *p95 = sorted[(sampleCount - 1) * 95 / 100];
+    *p99 = sorted[(sampleCount - 1) * 99 / 100];
+    return true;
+}
@@ -0,0 +1,21 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <SDL.h>
+
+// Input-to-present latency. An input is tagged with its SDL event timestamp
+// when the game acts on it; the next present closes every open tag, so each
+// sample is the time from the key or click to the first frame showing it.
+
+const int LATENCY_WINDOW = 512;
+
+// Call where an input changes game state, with the event's timestamp.
+void markInputHandled(Uint32 eventTimestamp);
+
+// Call right after SDL_RenderPresent.
+void markFramePresented();
+
+// Percentiles in ms over the last LATENCY_WINDOW samples; false if none yet.
+bool inputLatencyPercentiles(Uint32* p50, Uint32* p95, Uint32* p99);
+
+#endif // LATENCY_H
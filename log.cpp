@@ -0,0 +1,172 @@
+#include "log.h"
+#include "spsc.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* const LEVEL_NAMES[] = { "trace", "debug", "info", "warn", "error" };
+static const char* const CATEGORY_NAMES[LOG_CATEGORY_COUNT] = {
+    "app", "input", "game", "booster", "audio", "assets", "save", "render"
+};
+
+// Longest message kept; anything past it is cut off.
+static const int LOG_MESSAGE_BYTES = 192;
+static const Uint32 LOG_FLUSH_MS = 50;
+
+struct LogEntry {
+    Uint64 counter;
+    int level;
+    LogCategory category;
+    char message[LOG_MESSAGE_BYTES];
+};
+
+struct LogRing {
+    SpscQueue<LogEntry, 256> entries;
+    SDL_atomic_t dropped;
+};
+
+int runtimeLogLevel = LOG_LEVEL_INFO;
+
+static thread_local LogRing* threadRing = nullptr;
+static std::vector<LogRing*> rings;     // Guarded by ringsMutex.
+static SDL_mutex* ringsMutex = nullptr;
+static SDL_sem* flushNow = nullptr;
+static SDL_Thread* flusherThread = nullptr;
+static SDL_atomic_t flusherStopping;
+static Uint64 startCounter = 0;
+
+static void formatLine(std::string& out, const LogEntry& entry)
+{
+    char prefix[64];
+    double seconds = (double)(entry.counter - startCounter) / SDL_GetPerformanceFrequency();
+    std::snprintf(prefix, sizeof(prefix), "%9.3f %-5s %-7s ", seconds,
+                  LEVEL_NAMES[entry.level], CATEGORY_NAMES[entry.category]);
+    out += prefix;
+    out += entry.message;
+    out += '\n';
+}
+
+// Drains every ring into one write, ordered by time across threads.
+static void flushRings(std::vector<LogEntry>& batch, std::string& text)
+{
+    batch.clear();
+    text.clear();
+    SDL_LockMutex(ringsMutex);
+    for (LogRing* ring : rings) {
+        LogEntry entry;
+        while (ring->entries.pop(entry)) {
+            batch.push_back(entry);
+        }
+        int dropped = SDL_AtomicSet(&ring->dropped, 0);
+        if (dropped > 0) {
+            LogEntry note = { SDL_GetPerformanceCounter(), LOG_LEVEL_WARN, LOG_APP, "" };
+            std::snprintf(note.message, sizeof(note.message), "%d log messages dropped", dropped);
+            batch.push_back(note);
+        }
+    }
+    SDL_UnlockMutex(ringsMutex);
+    if (batch.empty())
+        return;
+
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const LogEntry& a, const LogEntry& b) { return a.counter < b.counter; });
+    for (const LogEntry& entry : batch) {
+        formatLine(text, entry);
+    }
+    std::fwrite(text.data(), 1, text.size(), stderr);
+    std::fflush(stderr);
+}
+
+static int logFlusher(void*)
+{
+    std::vector<LogEntry> batch;
+    std::string text;
+    while (!SDL_AtomicGet(&flusherStopping)) {
+        SDL_SemWaitTimeout(flushNow, LOG_FLUSH_MS);
+        flushRings(batch, text);
+    }
+    flushRings(batch, text);
+    return 0;
+}
+
+void startLogger()
+{
+    if (flusherThread)
+        return;
+    startCounter = SDL_GetPerformanceCounter();
+    ringsMutex = SDL_CreateMutex();
+    flushNow = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&flusherStopping, 0);
+    flusherThread = SDL_CreateThread(logFlusher, "LogFlusher", nullptr);
+}
+
+void stopLogger()
+{
+    if (!flusherThread)
+        return;
+    SDL_AtomicSet(&flusherStopping, 1);
+    SDL_SemPost(flushNow);
+    SDL_WaitThread(flusherThread, nullptr);
+    flusherThread = nullptr;
+    SDL_DestroySemaphore(flushNow);
+    flushNow = nullptr;
+    // Rings stay allocated: threads that outlive the logger still hold them.
+}
+
+void setLogLevel(int level)
+{
+    runtimeLogLevel = std::max(LOG_LEVEL_TRACE, std::min(level, LOG_LEVEL_ERROR));
+}
+
+int parseLogLevel(const char* name)
+{
+    for (int i = LOG_LEVEL_TRACE; i <= LOG_LEVEL_ERROR; i++) {
+        if (std::strcmp(name, LEVEL_NAMES[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static LogRing* ringForThisThread()
+{
+    if (!threadRing && ringsMutex) {
+        LogRing* ring = new LogRing();
+        SDL_AtomicSet(&ring->dropped, 0);
+        SDL_LockMutex(ringsMutex);
+        rings.push_back(ring);
+        SDL_UnlockMutex(ringsMutex);
+        threadRing = ring;
+    }
+    return threadRing;
+}
+
+void logWrite(int level, LogCategory category, const char* format, ...)
+{
+    LogEntry entry;
+    entry.counter = SDL_GetPerformanceCounter();
+    entry.level = level;
+    entry.category = category;
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(entry.message, sizeof(entry.message), format, args);
+    va_end(args);
+
+    LogRing* ring = flusherThread ? ringForThisThread() : nullptr;
+    if (!ring) {
+        // Before startLogger() or after stopLogger().
+        std::string line;
+        formatLine(line, entry);
+        std::fwrite(line.data(), 1, line.size(), stderr);
+        return;
+    }
+    if (!ring->entries.push(entry)) {
+        SDL_AtomicIncRef(&ring->dropped);
+        return;
+    }
+    if (level >= LOG_LEVEL_ERROR)
+        SDL_SemPost(flushNow);
+}
@@ -0,0 +1,76 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Asynchronous logger. A log call formats into a ring owned by the calling
+// thread and returns; a background thread drains every ring and writes the
+// lines to stderr in batches, so logging never waits on the terminal.
+//
+//   LOG_INFO(LOG_SAVE, "Resumed %u actions", count);
+//
+// Levels below LOG_COMPILED_LEVEL are removed by the preprocessor, arguments
+// and all. Release builds (NDEBUG) keep INFO and above; the runtime level,
+// set with --log-level, filters what is left.
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+
+#ifndef LOG_COMPILED_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILED_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_COMPILED_LEVEL LOG_LEVEL_TRACE
+#endif
+#endif
+
+enum LogCategory {
+    LOG_APP,
+    LOG_INPUT,
+    LOG_GAME,
+    LOG_BOOSTER,
+    LOG_AUDIO,
+    LOG_ASSETS,
+    LOG_SAVE,
+    LOG_RENDER,
+    LOG_CATEGORY_COUNT
+};
+
+extern int runtimeLogLevel;
+
+void startLogger();
+
+// Writes out everything still queued. Later log calls write directly.
+void stopLogger();
+
+void setLogLevel(int level);
+
+// Parses "trace", "debug", "info", "warn" or "error"; -1 if unknown.
+int parseLogLevel(const char* name);
+
+#ifdef __GNUC__
+__attribute__((format(printf, 3, 4)))
+#endif
+void logWrite(int level, LogCategory category, const char* format, ...);
+
+#define LOG_AT(level, category, ...) \
+    do { if ((level) >= runtimeLogLevel) logWrite((level), (category), __VA_ARGS__); } while (0)
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(category, ...) LOG_AT(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#else
+#define LOG_TRACE(category, ...) ((void)0)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void)0)
+#endif
+
+#define LOG_INFO(category, ...)  LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOG_WARN(category, ...)  LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+
+#endif // LOG_H
@@ -2,55 +2,203 @@
 #include <SDL_ttf.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
-#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "assets.h"
 #include "audio.h"
 #include "boosters.h"
+#include "capture.h"
+#include "diagnostics.h"
+#include "drawlist.h"
 #include "events.h"
+#include "exporter.h"
 #include "font.h"
 #include "game.h"
+#include "golden.h"
 #include "graphics.h"
+#include "history.h"
+#include "input.h"
+#include "pack.h"
+#include "persistence.h"
+#include "screens.h"
+#include "session.h"
+#include "softrender.h"
 #include "globals.h"
 #include "textures.h"
+#include "timers.h"
+#include "log.h"
+#include "marathon.h"
+#include "quality.h"
+
+// Longest idle sleep; a safety net for redraws nothing else wakes up.
+static const Uint32 IDLE_WAIT_MS = 500;
+
+// Whether the next frame would differ from the last one without any input.
+// Buffered moves count: each frame applies one, so the loop must not sleep
+// while any are waiting.
+static bool frameIsAnimating()
+{
+    return boosterActive || freezeActive || helpScrollVelocity != 0.0f
+        || pendingMoveInputs() > 0 || assetsPending() || diagnosticsVisible()
+        || (currentScreen() == UI_SCREEN_MARATHON && marathonAutoplay());
+}
+
+// The interactive game: restores the last session, or starts a marathon of
+// marathonBoards boards, and runs the main loop until the window is closed.
+static void runGame(int marathonBoards)
+{
+    loadHighscore();
+    startPersistence();
+    refreshHistorySummary();
+    if (marathonBoards > 0) {
+        startMarathon(marathonBoards);
+        changeScreen(UI_SCREEN_MARATHON);
+    }
+    // Pick up where the last run left off, even if it crashed.
+    else if (restoreSession()) {
+        changeScreen(UI_SCREEN_GAME);
+    }
+    startSession();
+
+    // Only the start screen background is worth waiting for; everything else
+    // streams in while the start screen is up.
+    while (!startBackground && assetsPending()) {
+        pumpAssetLoader(renderer, 10);
+    }
+
+    bool running = true;
+    while (running) {
+        pumpAssetLoader(renderer);
+        runDueTimers();
+        running = processEvents(window, renderer);
+        if (!running) {
+            break;
+        }
+        // Nothing on screen is moving: sleep until input or the next deadline.
+        if (!frameIsAnimating()) {
+            SDL_WaitEventTimeout(nullptr, (int)SDL_min(msUntilNextTimer(), IDLE_WAIT_MS));
+        }
+    }
+}
 
 int main(int argc, char* argv[])
 {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
-        std::cerr << "SDL init failed: " << SDL_GetError() << "\n";
+    // --compat-audio restores the old 2048-sample mixer buffer for devices
+    // that crackle at small buffer sizes; --no-audio runs without a device.
+    // --software-render skips the GPU even when there is one.
+    // --fixed-resolution always draws at full quality.
+    // --golden checks every screen against assets/golden and exits;
+    // --golden-update rewrites those images instead.
+    // --board-size=<n> plays on an n x n board, up to 32.
+    // --marathon=<n> plays n classic boards at once, up to 64.
+    // --texture-budget=<MB> caps texture memory.
+    // --input-buffer=<n> sets how many moves may wait to be applied.
+    // --record-downscale=<n> shrinks F9 recordings and exports n times.
+    // --export-replay=<file> renders a saved replay to <file>.y4m offscreen
+    // and exits; give it more than once to export several.
+    // --log-level=<trace|debug|info|warn|error> sets the log filter.
+    bool lowLatencyAudio = true;
+    bool audioWanted = true;
+    bool softwareWanted = false;
+    bool goldenMode = false;
+    bool goldenUpdate = false;
+    int marathonBoards = 0;
+    int downscale = 1;
+    std::vector<std::string> exportReplays;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--compat-audio")
+            lowLatencyAudio = false;
+        else if (arg == "--no-audio")
+            audioWanted = false;
+        else if (arg == "--software-render")
+            softwareWanted = true;
+        else if (arg == "--fixed-resolution")
+            setDynamicResolution(false);
+        else if (arg == "--golden")
+            goldenMode = true;
+        else if (arg == "--golden-update")
+            goldenMode = goldenUpdate = true;
+        else if (arg.compare(0, 13, "--board-size=") == 0) {
+            int size = std::atoi(arg.c_str() + 13);
+            if (size >= CLASSIC_GRID_SIZE && size <= MAX_GRID_SIZE)
+                GRID_SIZE = size;
+            else
+                LOG_WARN(LOG_APP, "Board size must be %d to %d; keeping %d.", CLASSIC_GRID_SIZE, MAX_GRID_SIZE, GRID_SIZE);
+        }
+        else if (arg.compare(0, 11, "--marathon=") == 0)
+            marathonBoards = std::atoi(arg.c_str() + 11);
+        else if (arg.compare(0, 17, "--texture-budget=") == 0)
+            setTextureBudget((size_t)std::atoi(arg.c_str() + 17) * 1024 * 1024);
+        else if (arg.compare(0, 15, "--input-buffer=") == 0)
+            setInputQueueDepth(std::atoi(arg.c_str() + 15));
+        else if (arg.compare(0, 19, "--record-downscale=") == 0)
+            downscale = std::atoi(arg.c_str() + 19);
+        else if (arg.compare(0, 16, "--export-replay=") == 0)
+            exportReplays.push_back(arg.substr(16));
+        else if (arg.compare(0, 12, "--log-level=") == 0) {
+            int level = parseLogLevel(arg.c_str() + 12);
+            if (level >= 0)
+                setLogLevel(level);
+            else
+                LOG_WARN(LOG_APP, "Unknown log level %s", arg.c_str() + 12);
+        }
+    }
+    setCaptureDownscale(downscale);
+    if (goldenMode || !exportReplays.empty()) {
+        // Offscreen and silent so it runs on machines with no display.
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        audioWanted = false;
+        softwareWanted = true;
+        setDynamicResolution(false);
+    }
+    if (goldenMode) {
+        // The reference images are of the classic board.
+        GRID_SIZE = CLASSIC_GRID_SIZE;
+    }
+
+    // Audio is brought up separately, and only when wanted, so a machine
+    // without an audio backend still runs the offscreen modes.
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        LOG_ERROR(LOG_APP, "SDL init failed: %s", SDL_GetError());
         return 1;
     }
     if (TTF_Init() != 0) {
-        std::cerr << "TTF init failed: " << TTF_GetError() << "\n";
+        LOG_ERROR(LOG_APP, "TTF init failed: %s", TTF_GetError());
         SDL_Quit();
         return 1;
     }
     if (!(IMG_Init(IMG_INIT_JPG|IMG_INIT_PNG) & (IMG_INIT_JPG|IMG_INIT_PNG))) {
-        std::cerr << "SDL_image init failed: " << IMG_GetError() << "\n";
+        LOG_ERROR(LOG_APP, "SDL_image init failed: %s", IMG_GetError());
         TTF_Quit();
         SDL_Quit();
         return 1;
     }
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        std::cerr << "SDL_mixer could not initialize! " << Mix_GetError() << "\n";
-        IMG_Quit();
-        TTF_Quit();
-        SDL_Quit();
-        return 1;
+    startLogger();
+    if (audioWanted && SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+        LOG_WARN(LOG_AUDIO, "No audio backend, continuing without sound: %s", SDL_GetError());
+        audioWanted = false;
+    }
+    if (audioWanted && !openAudioDevice(lowLatencyAudio)) {
+        LOG_WARN(LOG_AUDIO, "SDL_mixer could not initialize, continuing without sound: %s", Mix_GetError());
     }
 
     window = SDL_CreateWindow("2048 Fruits",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1100, 700, SDL_WINDOW_RESIZABLE);
     if (!window) {
-        std::cerr << "Window creation failed: " << SDL_GetError() << "\n";
+        LOG_ERROR(LOG_APP, "Window creation failed: %s", SDL_GetError());
+        stopLogger();
         Mix_CloseAudio();
         IMG_Quit();
         TTF_Quit();
         SDL_Quit();
         return 1;
     }
-    renderer = SDL_CreateRenderer(window, -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    renderer = createGameRenderer(window, softwareWanted);
     if (!renderer) {
-        std::cerr << "Renderer creation failed: " << SDL_GetError() << "\n";
+        LOG_ERROR(LOG_APP, "Renderer creation failed: %s", SDL_GetError());
+        stopLogger();
         SDL_DestroyWindow(window);
         Mix_CloseAudio();
         IMG_Quit();
@@ -59,38 +207,45 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    if (!initAudio()) {
-        std::cerr << "Some audio files failed to load.\n";
+    // Pre-decoded assets built by tools/packassets; loose files are the fallback.
+    if (!openAssetPack("assets/assets.pak")) {
+        LOG_INFO(LOG_ASSETS, "No asset pack found, loading loose asset files.");
     }
+    startAssetLoader();
     if (!loadAllTextures(renderer)) {
-        std::cerr << "Some textures failed to load.\n";
+        LOG_WARN(LOG_ASSETS, "Some textures failed to load.");
     }
+    loadBoosterTextures(renderer);
+    if (!initAudio()) {
+        LOG_WARN(LOG_AUDIO, "Some audio files failed to load.");
+    }
+    // Fonts stay on this thread; FreeType handles are not shared across threads.
     if (!initFont()){
-        std::cerr << "Some fonts failed to load.\n";
+        LOG_WARN(LOG_ASSETS, "Some fonts failed to load.");
     }
 
     recomputeLayout(window);
-    loadHighscore();
-    loadBoosterTextures(renderer);
-
-    bool running = true;
-    while (running) {
-        running = processEvents(window, renderer);
-        if (boosterActive) {
-            Uint32 elapsed = SDL_GetTicks() - boosterStartTime;
-            if (elapsed >= currentBooster.duration) {
-                boosterActive = false;
-                std::cerr << "Booster expired." << std::endl;
-            }
-        }
-        if (!running) {
-            break;
-        }
+    int exitCode = 0;
+    if (goldenMode) {
+        exitCode = runGoldenImages(window, renderer, goldenUpdate) ? 0 : 1;
+    } else if (!exportReplays.empty()) {
+        exitCode = runReplayExport(window, renderer, exportReplays, downscale) ? 0 : 1;
+    } else {
+        runGame(marathonBoards);
     }
 
+    stopCapture();
+    stopSession();
+    stopPersistence();
+    stopAssetLoader();
+    freeTextPages();
+    freeScaledCopies();
+    freeDrawListTargets();
     freeAllFont();
     freeAllTextures();
     cleanupAudio();
+    closeAssetPack();
+    stopLogger();
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -98,7 +253,7 @@ int main(int argc, char* argv[])
     IMG_Quit();
     TTF_Quit();
     SDL_Quit();
-    return 0;
+    return exitCode;
 }
 
 
@@ -0,0 +1,74 @@
+#include "mapped.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool mapFile(const char* path, MappedFile& mapped, bool willNeed)
+{
+    DWORD flags = FILE_ATTRIBUTE_NORMAL | (willNeed ? FILE_FLAG_SEQUENTIAL_SCAN : 0);
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    mapped.data = (const unsigned char*)base;
+    mapped.size = (size_t)size.QuadPart;
+    mapped.file = file;
+    mapped.mapping = mapping;
+    return true;
+}
+
+void unmapFile(MappedFile& mapped)
+{
+    if (mapped.data)    UnmapViewOfFile(mapped.data);
+    if (mapped.mapping) CloseHandle(mapped.mapping);
+    if (mapped.file)    CloseHandle(mapped.file);
+    mapped = MappedFile();
+}
+#else
+bool mapFile(const char* path, MappedFile& mapped, bool willNeed)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    if (willNeed)
+        madvise(base, (size_t)st.st_size, MADV_WILLNEED);
+    mapped.data = (const unsigned char*)base;
+    mapped.size = (size_t)st.st_size;
+    return true;
+}
+
+void unmapFile(MappedFile& mapped)
+{
+    if (mapped.data)
+        munmap((void*)mapped.data, mapped.size);
+    mapped = MappedFile();
+}
+#endif
@@ -0,0 +1,22 @@
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file.
+struct MappedFile {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+// Fails for missing or empty files. willNeed asks the OS to start paging the
+// file in at once, for files that are about to be read end to end.
+bool mapFile(const char* path, MappedFile& mapped, bool willNeed = false);
+
+void unmapFile(MappedFile& mapped);
+
+#endif // MAPPED_H
@@ -0,0 +1,215 @@
+#include "marathon.h"
+#include "boosters.h"
+#include "game.h"
+#include "timers.h"
+#include "log.h"
+#include <ctime>
+
+static const SDL_Keycode MOVES[4] = { SDLK_UP, SDLK_DOWN, SDLK_LEFT, SDLK_RIGHT };
+// Blockers on a board before the autoplayer pays for a freeze.
+static const int AUTOPLAY_FREEZE_BLOCKERS = 3;
+
+static MarathonBoard boards[MAX_MARATHON_BOARDS];
+static int boardCount = 0;
+static bool autoplay = true;
+static int gamesFinished = 0;
+static int movesThisSecond = 0;
+static int movesPerSecond = 0;
+static Uint32 secondStart = 0;
+
+// Puts a board into the game globals for the engine to work on.
+static void loadBoard(const MarathonBoard& b, Uint32 now)
+{
+    for (int i = 0; i < CLASSIC_GRID_SIZE; i++) {
+        for (int j = 0; j < CLASSIC_GRID_SIZE; j++) {
+            grid[i][j] = unpackCell(b.cells[i][j]);
+        }
+    }
+    score = b.score;
+    currentBooster = b.booster;
+    boosterActive = now < b.boosterUntil;
+    freezeActive = now < b.freezeUntil;
+    lock2048 = false;
+    for (const auto& pair : boosterSettings) {
+        boosterActivated[pair.first] = (b.boosterActivatedMask >> tileExponent(pair.first)) & 1;
+    }
+}
+
+static void storeBoard(MarathonBoard& b, Uint32 now)
+{
+    for (int i = 0; i < CLASSIC_GRID_SIZE; i++) {
+        for (int j = 0; j < CLASSIC_GRID_SIZE; j++) {
+            b.cells[i][j] = packCell(grid[i][j]);
+        }
+    }
+    b.score = score;
+    b.booster = currentBooster;
+    b.boosterActivatedMask = 0;
+    for (const auto& pair : boosterActivated) {
+        if (pair.second)
+            b.boosterActivatedMask |= 1u << tileExponent(pair.first);
+    }
+    // A multiplier earned by this move was armed on the shared timer; the
+    // board keeps it as its own deadline instead.
+    Uint32 remaining = timerRemaining(TIMER_BOOSTER);
+    if (remaining > 0)
+        b.boosterUntil = now + remaining;
+    cancelTimer(TIMER_BOOSTER);
+    b.over = is_game_over();
+}
+
+static void dealBoard(MarathonBoard& b, Uint32 now)
+{
+    b = MarathonBoard();
+    b.booster = { 100, 0 };
+    loadBoard(b, now);
+    add_random_tile();
+    storeBoard(b, now);
+}
+
+static void moveBoard(MarathonBoard& b, SDL_Keycode key, Uint32 now)
+{
+    loadBoard(b, now);
+    if (step_board(key))
+        movesThisSecond++;
+    storeBoard(b, now);
+    if (b.over)
+        gamesFinished++;
+}
+
+// Greedy one-move lookahead: points scored plus room left on the board.
+// SDLK_UNKNOWN if nothing moves.
+static SDL_Keycode chooseMove(const MarathonBoard& b, Uint32 now)
+{
+    SDL_Keycode best = SDLK_UNKNOWN;
+    int bestValue = -1;
+    for (SDL_Keycode key : MOVES) {
+        loadBoard(b, now);
+        if (!slide_tiles(key))
+            continue;
+        int empty = 0;
+        for (int i = 0; i < CLASSIC_GRID_SIZE; i++) {
+            for (int j = 0; j < CLASSIC_GRID_SIZE; j++) {
+                empty += grid[i][j] == 0;
+            }
+        }
+        int value = incrementscore + 32 * empty;
+        if (value > bestValue) {
+            bestValue = value;
+            best = key;
+        }
+    }
+    cancelTimer(TIMER_BOOSTER);
+    return best;
+}
+
+// The autoplayer's shopping: a freeze once blockers pile up, otherwise a
+// hammer for the last blocker on the board.
+static void useBoosters(MarathonBoard& b, Uint32 now)
+{
+    int blockers = 0, row = -1, col = -1;
+    for (int i = 0; i < CLASSIC_GRID_SIZE; i++) {
+        for (int j = 0; j < CLASSIC_GRID_SIZE; j++) {
+            if (b.cells[i][j] == PACKED_BLOCKER) {
+                blockers++;
+                row = i;
+                col = j;
+            }
+        }
+    }
+    if (blockers >= AUTOPLAY_FREEZE_BLOCKERS && now >= b.freezeUntil && b.score >= freezeButton.cost) {
+        b.score -= freezeButton.cost;
+        b.freezeUntil = now + FREEZE_DURATION;
+    }
+    else if (blockers > 0 && b.score >= hammerButton.cost) {
+        b.score -= hammerButton.cost;
+        b.cells[row][col] = 0;
+    }
+}
+
+void startMarathon(int count)
+{
+    boardCount = SDL_max(1, SDL_min(count, MAX_MARATHON_BOARDS));
+    // Marathon boards are classic boards whatever --board-size says.
+    GRID_SIZE = CLASSIC_GRID_SIZE;
+    seedGameRandom((Uint32)time(nullptr));
+    autoplay = true;
+    restartMarathon();
+    LOG_INFO(LOG_GAME, "Marathon started with %d boards.", boardCount);
+}
+
+void restartMarathon()
+{
+    Uint32 now = SDL_GetTicks();
+    for (int n = 0; n < boardCount; n++) {
+        dealBoard(boards[n], now);
+    }
+    gamesFinished = 0;
+    movesThisSecond = 0;
+    movesPerSecond = 0;
+    secondStart = now;
+}
+
+void marathonMove(SDL_Keycode key)
+{
+    Uint32 now = SDL_GetTicks();
+    for (int n = 0; n < boardCount; n++) {
+        if (!boards[n].over)
+            moveBoard(boards[n], key, now);
+    }
+}
+
+void toggleMarathonAutoplay()
+{
+    autoplay = !autoplay;
+    LOG_DEBUG(LOG_GAME, "Marathon autoplay %s.", autoplay ? "on" : "off");
+}
+
+bool marathonAutoplay()
+{
+    return autoplay;
+}
+
+void updateMarathon()
+{
+    Uint32 now = SDL_GetTicks();
+    if (now - secondStart >= 1000) {
+        movesPerSecond = movesThisSecond;
+        movesThisSecond = 0;
+        secondStart = now;
+    }
+    if (!autoplay)
+        return;
+    for (int n = 0; n < boardCount; n++) {
+        MarathonBoard& b = boards[n];
+        if (b.over) {
+            dealBoard(b, now);
+            continue;
+        }
+        useBoosters(b, now);
+        SDL_Keycode key = chooseMove(b, now);
+        if (key == SDLK_UNKNOWN) {
+            // Walled in by blockers with space left: nothing to do but end it.
+            b.over = true;
+            gamesFinished++;
+            continue;
+        }
+        moveBoard(b, key, now);
+    }
+}
+
+const MarathonBoard* marathonBoards(int* count)
+{
+    *count = boardCount;
+    return boards;
+}
+
+int marathonMovesPerSecond()
+{
+    return movesPerSecond;
+}
+
+int marathonGamesFinished()
+{
+    return gamesFinished;
+}
@@ -0,0 +1,48 @@
+#ifndef MARATHON_H
+#define MARATHON_H
+
+#include <SDL.h>
+#include "globals.h"
+
+// Marathon: many independent classic boards played at once. There is still
+// one engine; each board is swapped into the game globals, stepped with the
+// same code as the single game and swapped back out. Boards keep their own
+// blockers, score multipliers and freeze, and never touch the saved game,
+// the history or the highscore.
+
+const int MAX_MARATHON_BOARDS = 64;
+
+struct MarathonBoard {
+    Uint8 cells[CLASSIC_GRID_SIZE][CLASSIC_GRID_SIZE];  // See packCell().
+    int score;
+    Booster booster;
+    Uint32 boosterActivatedMask;    // Bit n set if the 2^n booster was used.
+    Uint32 boosterUntil;            // SDL_GetTicks() deadlines; past when off.
+    Uint32 freezeUntil;
+    bool over;
+};
+
+// Deals n boards (1-MAX_MARATHON_BOARDS) and hands them to the autoplayer.
+void startMarathon(int boards);
+
+// Deals every board again.
+void restartMarathon();
+
+// Applies a move to every board still in play.
+void marathonMove(SDL_Keycode key);
+
+// The autoplayer makes one move per board each frame and deals finished
+// boards again; with it off the arrow keys drive all boards.
+void toggleMarathonAutoplay();
+bool marathonAutoplay();
+
+// Once per frame while the marathon screen is up.
+void updateMarathon();
+
+const MarathonBoard* marathonBoards(int* count);
+
+// Moves across all boards in the last full second, and games finished.
+int marathonMovesPerSecond();
+int marathonGamesFinished();
+
+#endif // MARATHON_H
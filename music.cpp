@@ -0,0 +1,251 @@
+#include "music.h"
+#include "assets.h"
+#include "log.h"
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <vector>
+
+struct TrackInfo {
+    const char* path;
+    bool loop;
+    MusicTrack next;    // Played when a non-looping track ends.
+};
+
+static const TrackInfo TRACKS[MUSIC_TRACK_COUNT] = {
+    { "assets/music and sfx/linga guli guli.mp3", true,  MUSIC_NONE },
+    { "assets/music and sfx/newrec.mp3",          false, MUSIC_BACKGROUND },
+    { "assets/music and sfx/congratulation.mp3",  true,  MUSIC_NONE },
+};
+
+// Ring of interleaved S16 frames; a power of two so the free-running
+// counters can wrap. 8192 frames is ~190ms at 44.1kHz, which bounds how
+// late a track change is heard.
+static const Uint32 RING_FRAMES = 8192;
+static const Uint32 BLOCK_FRAMES = 1024;
+static const Uint32 STREAMER_WAKE_MS = 10;
+
+static std::vector<Sint16> ring;
+static SDL_atomic_t ringRead;       // Advanced by the audio thread only.
+static SDL_atomic_t ringWrite;      // Advanced by the streamer only.
+static SDL_atomic_t musicVolumeLevel;
+static SDL_atomic_t underruns;
+
+static int outputFrequency = 0;
+static int outputChannels = 0;
+
+// Shared between the main thread and the streamer, under musicMutex.
+static SDL_mutex* musicMutex = nullptr;
+static SDL_cond* musicWake = nullptr;
+static SDL_Thread* streamerThread = nullptr;
+static bool streamerStopping = false;
+static Mix_Chunk* decoded[MUSIC_TRACK_COUNT];
+static bool requested[MUSIC_TRACK_COUNT];
+static MusicTrack wantedTrack = MUSIC_NONE;
+static Uint32 wantedSerial = 0;
+
+// A track being mixed by the streamer.
+struct MusicVoice {
+    MusicTrack track;
+    Uint32 frame;
+    float gain;
+    float target;
+};
+
+static void musicHook(void*, Uint8* stream, int len)
+{
+    Sint16* out = (Sint16*)stream;
+    Uint32 frames = (Uint32)len / (outputChannels * sizeof(Sint16));
+    Uint32 read = (Uint32)SDL_AtomicGet(&ringRead);
+    Uint32 available = (Uint32)SDL_AtomicGet(&ringWrite) - read;
+    Uint32 count = available < frames ? available : frames;
+    int volume = SDL_AtomicGet(&musicVolumeLevel);
+
+    for (Uint32 i = 0; i < count; i++) {
+        const Sint16* in = &ring[((read + i) & (RING_FRAMES - 1)) * outputChannels];
+        for (int c = 0; c < outputChannels; c++) {
+            *out++ = (Sint16)(in[c] * volume / MIX_MAX_VOLUME);
+        }
+    }
+    if (count < frames) {
+        SDL_memset(out, 0, (frames - count) * outputChannels * sizeof(Sint16));
+        SDL_AtomicIncRef(&underruns);
+    }
+    SDL_AtomicSet(&ringRead, (int)(read + count));
+}
+
+// Mixes one voice into acc, ramping its gain toward target. Returns false
+// once a non-looping track has run out.
+static bool mixVoice(MusicVoice& voice, Mix_Chunk* pcm, std::vector<int>& acc, Uint32 frames, float step)
+{
+    const Sint16* samples = (const Sint16*)pcm->abuf;
+    Uint32 length = pcm->alen / (outputChannels * sizeof(Sint16));
+    for (Uint32 i = 0; i < frames; i++) {
+        if (voice.frame >= length) {
+            if (!TRACKS[voice.track].loop || length == 0)
+                return false;
+            voice.frame = 0;
+        }
+        if (voice.gain < voice.target)      voice.gain = SDL_min(voice.gain + step, voice.target);
+        else if (voice.gain > voice.target) voice.gain = SDL_max(voice.gain - step, voice.target);
+        const Sint16* in = &samples[voice.frame * outputChannels];
+        for (int c = 0; c < outputChannels; c++) {
+            acc[i * outputChannels + c] += (int)(in[c] * voice.gain);
+        }
+        voice.frame++;
+    }
+    return true;
+}
+
+static int streamerMain(void*)
+{
+    MusicVoice current = { MUSIC_NONE, 0, 0.0f, 1.0f };
+    MusicVoice outgoing = { MUSIC_NONE, 0, 0.0f, 0.0f };
+    Uint32 seenSerial = 0;
+    float step = 1000.0f / (MUSIC_CROSSFADE_MS * (float)outputFrequency);
+    std::vector<int> acc(BLOCK_FRAMES * outputChannels);
+
+    SDL_LockMutex(musicMutex);
+    while (!streamerStopping) {
+        Uint32 space = RING_FRAMES - ((Uint32)SDL_AtomicGet(&ringWrite) - (Uint32)SDL_AtomicGet(&ringRead));
+        if (space < BLOCK_FRAMES) {
+            SDL_CondWaitTimeout(musicWake, musicMutex, STREAMER_WAKE_MS);
+            continue;
+        }
+
+        if (seenSerial != wantedSerial) {
+            seenSerial = wantedSerial;
+            if (wantedTrack != current.track) {
+                outgoing = current;
+                outgoing.target = 0.0f;
+                current = { wantedTrack, 0, 0.0f, 1.0f };
+            }
+        }
+        Mix_Chunk* currentPcm = current.track != MUSIC_NONE ? decoded[current.track] : nullptr;
+        Mix_Chunk* outgoingPcm = outgoing.track != MUSIC_NONE ? decoded[outgoing.track] : nullptr;
+        SDL_UnlockMutex(musicMutex);
+
+        // Decoded chunks are only freed after this thread is joined, so they
+        // can be read without the lock.
+        std::fill(acc.begin(), acc.end(), 0);
+        if (outgoingPcm && (outgoing.gain <= 0.0f || !mixVoice(outgoing, outgoingPcm, acc, BLOCK_FRAMES, step)))
+            outgoing.track = MUSIC_NONE;
+        bool finished = false;
+        if (currentPcm)
+            finished = !mixVoice(current, currentPcm, acc, BLOCK_FRAMES, step);
+
+        Uint32 write = (Uint32)SDL_AtomicGet(&ringWrite);
+        for (Uint32 i = 0; i < BLOCK_FRAMES * outputChannels; i++) {
+            int sample = SDL_clamp(acc[i], -32768, 32767);
+            ring[((write + i / outputChannels) & (RING_FRAMES - 1)) * outputChannels + i % outputChannels] = (Sint16)sample;
+        }
+        SDL_AtomicSet(&ringWrite, (int)(write + BLOCK_FRAMES));
+
+        SDL_LockMutex(musicMutex);
+        if (finished && wantedTrack == current.track) {
+            MusicTrack next = TRACKS[current.track].next;
+            wantedTrack = next;
+            current = { next, 0, 1.0f, 1.0f };
+        }
+    }
+    SDL_UnlockMutex(musicMutex);
+    return 0;
+}
+
+void startMusicStreamer()
+{
+    if (streamerThread)
+        return;
+    Uint16 format = 0;
+    if (!Mix_QuerySpec(&outputFrequency, &format, &outputChannels) || format != AUDIO_S16SYS) {
+        LOG_WARN(LOG_AUDIO, "Music streaming needs a 16-bit mixer; music disabled.");
+        return;
+    }
+
+    ring.assign(RING_FRAMES * outputChannels, 0);
+    SDL_AtomicSet(&ringRead, 0);
+    SDL_AtomicSet(&ringWrite, 0);
+    SDL_AtomicSet(&underruns, 0);
+    musicMutex = SDL_CreateMutex();
+    musicWake = SDL_CreateCond();
+    streamerStopping = false;
+    streamerThread = SDL_CreateThread(streamerMain, "MusicStreamer", nullptr);
+    if (!streamerThread) {
+        LOG_ERROR(LOG_AUDIO, "Failed to start music streamer: %s", SDL_GetError());
+        return;
+    }
+    Mix_HookMusic(musicHook, nullptr);
+}
+
+void stopMusicStreamer()
+{
+    if (streamerThread) {
+        Mix_HookMusic(nullptr, nullptr);
+        SDL_LockMutex(musicMutex);
+        streamerStopping = true;
+        SDL_CondSignal(musicWake);
+        SDL_UnlockMutex(musicMutex);
+        SDL_WaitThread(streamerThread, nullptr);
+        streamerThread = nullptr;
+    }
+    for (int i = 0; i < MUSIC_TRACK_COUNT; i++) {
+        if (decoded[i]) {
+            Mix_FreeChunk(decoded[i]);
+            decoded[i] = nullptr;
+        }
+        requested[i] = false;
+    }
+    if (musicWake)  SDL_DestroyCond(musicWake);
+    if (musicMutex) SDL_DestroyMutex(musicMutex);
+    musicWake = nullptr;
+    musicMutex = nullptr;
+    wantedTrack = MUSIC_NONE;
+}
+
+void prefetchMusicTrack(MusicTrack track)
+{
+    if (!musicMutex || track == MUSIC_NONE || requested[track])
+        return;
+    requested[track] = true;
+    if (TRACKS[track].next != MUSIC_NONE)
+        prefetchMusicTrack(TRACKS[track].next);
+    // The asset loader decodes the whole file to mixer PCM off the main
+    // thread; the callback only hands the pointer over.
+    requestChunk(TRACKS[track].path, [track](Mix_Chunk* chunk) {
+        if (!musicMutex) {
+            if (chunk) Mix_FreeChunk(chunk);
+            return;
+        }
+        SDL_LockMutex(musicMutex);
+        decoded[track] = chunk;
+        SDL_UnlockMutex(musicMutex);
+    });
+}
+
+void playMusicTrack(MusicTrack track)
+{
+    if (!musicMutex)
+        return;
+    SDL_LockMutex(musicMutex);
+    wantedTrack = track;
+    wantedSerial++;
+    SDL_CondSignal(musicWake);
+    SDL_UnlockMutex(musicMutex);
+}
+
+void setMusicStreamVolume(int volume)
+{
+    SDL_AtomicSet(&musicVolumeLevel, SDL_clamp(volume, 0, MIX_MAX_VOLUME));
+}
+
+int musicBufferedMs()
+{
+    if (!outputFrequency)
+        return 0;
+    Uint32 buffered = (Uint32)SDL_AtomicGet(&ringWrite) - (Uint32)SDL_AtomicGet(&ringRead);
+    return (int)(buffered * 1000 / outputFrequency);
+}
+
+int musicUnderruns()
+{
+    return SDL_AtomicGet(&underruns);
+}
@@ -0,0 +1,41 @@
+#ifndef MUSIC_H
+#define MUSIC_H
+
+#include <SDL.h>
+
+// Background music streamer. Tracks are decoded to PCM on the asset workers;
+// a streamer thread mixes the playing track, and the one fading out, into a
+// ring buffer that the mixer's music hook drains on the audio thread. Game
+// code only ever posts requests, so nothing here can stall a frame.
+
+enum MusicTrack {
+    MUSIC_NONE = -1,
+    MUSIC_BACKGROUND,
+    MUSIC_RECORD,      // New highscore jingle; returns to the background track.
+    MUSIC_WIN,
+    MUSIC_TRACK_COUNT
+};
+
+const int MUSIC_CROSSFADE_MS = 400;
+
+// Start after Mix_OpenAudio and the asset loader; stop before Mix_CloseAudio.
+void startMusicStreamer();
+void stopMusicStreamer();
+
+// Starts decoding a track, and the one that follows it, so a later
+// playMusicTrack begins without delay. Main thread only.
+void prefetchMusicTrack(MusicTrack track);
+
+// Crossfades to the track, or fades out for MUSIC_NONE. A track that is not
+// decoded yet starts as soon as it has been prefetched and decoded. Safe to
+// call from any thread.
+void playMusicTrack(MusicTrack track);
+
+// 0..MIX_MAX_VOLUME.
+void setMusicStreamVolume(int volume);
+
+// Diagnostics.
+int musicBufferedMs();
+int musicUnderruns();
+
+#endif // MUSIC_H
@@ -0,0 +1,99 @@
+#include "pack.h"
+#include "mapped.h"
+#include "log.h"
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <cstring>
+
+static MappedFile pack;
+static const Uint8* packBase = nullptr;
+static size_t packSize = 0;
+static const PackEntry* packEntries = nullptr;
+static Uint32 packEntryCount = 0;
+
+bool openAssetPack(const char* path)
+{
+    if (packBase)
+        return true;
+    // The whole pack is read during startup; let the OS start paging it in.
+    if (!mapFile(path, pack, true))
+        return false;
+    packBase = pack.data;
+    packSize = pack.size;
+
+    const PackHeader* header = (const PackHeader*)packBase;
+    bool valid = packSize >= sizeof(PackHeader)
+        && std::memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0
+        && header->version == PACK_VERSION
+        && sizeof(PackHeader) + (size_t)header->entryCount * sizeof(PackEntry) <= packSize;
+    if (valid) {
+        packEntries = (const PackEntry*)(packBase + sizeof(PackHeader));
+        packEntryCount = header->entryCount;
+        for (Uint32 i = 0; i < packEntryCount && valid; i++) {
+            valid = packEntries[i].offset + packEntries[i].size <= packSize;
+        }
+    }
+    if (!valid) {
+        LOG_WARN(LOG_ASSETS, "Ignoring invalid asset pack %s", path);
+        closeAssetPack();
+        return false;
+    }
+    return true;
+}
+
+void closeAssetPack()
+{
+    unmapFile(pack);
+    packBase = nullptr;
+    packSize = 0;
+    packEntries = nullptr;
+    packEntryCount = 0;
+}
+
+bool assetPackOpen()
+{
+    return packBase != nullptr;
+}
+
+const PackEntry* findPackEntry(Uint64 id)
+{
+    if (!packEntries)
+        return nullptr;
+    const PackEntry* end = packEntries + packEntryCount;
+    const PackEntry* it = std::lower_bound(packEntries, end, id,
+        [](const PackEntry& e, Uint64 value) { return e.id < value; });
+    return (it != end && it->id == id) ? it : nullptr;
+}
+
+SDL_Surface* packSurface(const PackEntry* entry)
+{
+    if (!entry || entry->kind != PACK_IMAGE)
+        return nullptr;
+    // SDL only reads from the pixels when creating a texture, so handing it
+    // the read-only mapping is safe.
+    return SDL_CreateRGBSurfaceWithFormatFrom((void*)(packBase + entry->offset),
+                                              entry->width, entry->height,
+                                              SDL_BYTESPERPIXEL(entry->format) * 8,
+                                              entry->pitch, entry->format);
+}
+
+Mix_Chunk* packChunk(const PackEntry* entry)
+{
+    if (!entry || entry->kind != PACK_AUDIO)
+        return nullptr;
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    if (!Mix_QuerySpec(&frequency, &format, &channels))
+        return nullptr;
+    if ((Uint32)frequency != entry->width || format != entry->format || (Uint32)channels != entry->height)
+        return nullptr;
+    return Mix_QuickLoad_RAW((Uint8*)(packBase + entry->offset), (Uint32)entry->size);
+}
+
+SDL_RWops* packRW(const PackEntry* entry)
+{
+    if (!entry)
+        return nullptr;
+    return SDL_RWFromConstMem(packBase + entry->offset, (int)entry->size);
+}
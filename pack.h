@@ -0,0 +1,80 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+// Pre-decoded asset pack, produced by tools/packassets and memory-mapped at
+// runtime. Layout:
+//
+//   PackHeader
+//   PackEntry[entryCount]   sorted by id
+//   data blobs              each aligned to PACK_ALIGNMENT
+//
+// Images are stored as raw pixels in a renderer-native format, sound effects
+// as PCM already in the mixer's output format, and music and fonts as the
+// original file bytes.
+
+const char PACK_MAGIC[8] = { '2', '0', '4', '8', 'P', 'A', 'K', '\0' };
+const Uint32 PACK_VERSION = 1;
+const Uint32 PACK_ALIGNMENT = 64;
+
+enum PackEntryKind {
+    PACK_IMAGE = 1,   // format = SDL pixel format, width/height/pitch in pixels/bytes.
+    PACK_AUDIO = 2,   // format = SDL audio format, width = frequency, height = channels.
+    PACK_RAW   = 3    // Unmodified file contents.
+};
+
+struct PackHeader {
+    char magic[8];
+    Uint32 version;
+    Uint32 entryCount;
+};
+
+struct PackEntry {
+    Uint64 id;
+    Uint32 kind;
+    Uint32 format;
+    Uint32 width;
+    Uint32 height;
+    Uint32 pitch;
+    Uint32 reserved;
+    Uint64 offset;
+    Uint64 size;
+};
+
+// 64-bit FNV-1a of an asset path such as "assets/Fruit/apple.jpg". Usable in
+// constant expressions so literal paths hash at compile time.
+constexpr Uint64 assetIdStep(const char* s, Uint64 h)
+{
+    return *s ? assetIdStep(s + 1, (h ^ (Uint8)*s) * 1099511628211ULL) : h;
+}
+
+constexpr Uint64 assetId(const char* path)
+{
+    return assetIdStep(path, 14695981039346656037ULL);
+}
+
+// Maps the pack read-only. Returns false (and leaves loading to the loose
+// files) if it is missing or not a valid pack.
+bool openAssetPack(const char* path);
+
+// Unmaps the pack. Anything created from it must already be freed.
+void closeAssetPack();
+
+bool assetPackOpen();
+
+// Binary search of the table of contents; nullptr if the id is not packed.
+const PackEntry* findPackEntry(Uint64 id);
+
+// Surface that points straight at the mapped pixels; no copy is made.
+SDL_Surface* packSurface(const PackEntry* entry);
+
+// Chunk that plays straight from the mapped PCM. Returns nullptr if it was
+// packed for a different output format than the mixer is running at.
+Mix_Chunk* packChunk(const PackEntry* entry);
+
+// Read-only stream over an entry, for fonts and music.
+SDL_RWops* packRW(const PackEntry* entry);
+
+#endif // PACK_H
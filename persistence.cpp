@@ -0,0 +1,184 @@
+#include "persistence.h"
+#include "log.h"
+#include <SDL.h>
+#include <deque>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static SDL_Thread* persistThread = nullptr;
+static SDL_mutex* persistMutex = nullptr;
+static SDL_cond* persistWake = nullptr;
+static bool persistStopping = false;
+
+static bool highscoreDirty = false;
+static int pendingHighscore = 0;
+static std::deque<std::function<void()>> tasks;
+
+#ifdef _WIN32
+bool writeFileAtomically(const std::string& path, const std::string& contents)
+{
+    std::string temp = path + ".tmp";
+    HANDLE file = CreateFileA(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    DWORD written = 0;
+    bool ok = WriteFile(file, contents.data(), (DWORD)contents.size(), &written, nullptr)
+        && written == contents.size()
+        && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (ok)
+        ok = MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+    if (!ok)
+        DeleteFileA(temp.c_str());
+    return ok;
+}
+#else
+bool writeFileAtomically(const std::string& path, const std::string& contents)
+{
+    std::string temp = path + ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    size_t done = 0;
+    while (done < contents.size()) {
+        ssize_t n = write(fd, contents.data() + done, contents.size() - done);
+        if (n <= 0)
+            break;
+        done += (size_t)n;
+    }
+    bool ok = done == contents.size() && fsync(fd) == 0;
+    close(fd);
+    if (ok)
+        ok = rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        unlink(temp.c_str());
+        return false;
+    }
+    // Make the rename itself durable.
+    std::string dir = path.substr(0, path.find_last_of('/') == std::string::npos ? 0 : path.find_last_of('/'));
+    int dirFd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
+#endif
+
+static void writeHighscore(int value)
+{
+    if (!writeFileAtomically(HIGHSCORE_PATH, std::to_string(value)))
+        LOG_ERROR(LOG_SAVE, "Failed to save highscore to %s", HIGHSCORE_PATH);
+}
+
+static int persistWorker(void*)
+{
+    Uint32 lastWrite = 0;
+    SDL_LockMutex(persistMutex);
+    for (;;) {
+        while (!highscoreDirty && tasks.empty() && !persistStopping)
+            SDL_CondWait(persistWake, persistMutex);
+
+        while (!tasks.empty()) {
+            std::function<void()> task = tasks.front();
+            tasks.pop_front();
+            SDL_UnlockMutex(persistMutex);
+            task();
+            SDL_LockMutex(persistMutex);
+        }
+        if (!highscoreDirty && !persistStopping)
+            continue;
+
+        // Hold off until the interval has passed so a run of new records
+        // collapses into one write.
+        Uint32 since = SDL_GetTicks() - lastWrite;
+        if (!persistStopping && lastWrite != 0 && since < PERSIST_INTERVAL_MS) {
+            SDL_CondWaitTimeout(persistWake, persistMutex, PERSIST_INTERVAL_MS - since);
+            continue;
+        }
+
+        if (highscoreDirty) {
+            int value = pendingHighscore;
+            highscoreDirty = false;
+            SDL_UnlockMutex(persistMutex);
+            writeHighscore(value);
+            lastWrite = SDL_GetTicks();
+            if (lastWrite == 0) lastWrite = 1;
+            SDL_LockMutex(persistMutex);
+        }
+        if (persistStopping && !highscoreDirty && tasks.empty())
+            break;
+    }
+    SDL_UnlockMutex(persistMutex);
+    return 0;
+}
+
+void startPersistence()
+{
+    if (persistThread)
+        return;
+    persistMutex = SDL_CreateMutex();
+    persistWake = SDL_CreateCond();
+    persistStopping = false;
+    persistThread = SDL_CreateThread(persistWorker, "Persistence", nullptr);
+    if (!persistThread)
+        LOG_ERROR(LOG_SAVE, "Failed to start persistence thread: %s", SDL_GetError());
+}
+
+void stopPersistence()
+{
+    if (persistThread) {
+        SDL_LockMutex(persistMutex);
+        persistStopping = true;
+        SDL_CondSignal(persistWake);
+        SDL_UnlockMutex(persistMutex);
+        SDL_WaitThread(persistThread, nullptr);
+        persistThread = nullptr;
+    } else {
+        for (const auto& task : tasks) {
+            task();
+        }
+        tasks.clear();
+        if (highscoreDirty) {
+            writeHighscore(pendingHighscore);
+            highscoreDirty = false;
+        }
+    }
+    if (persistWake)  SDL_DestroyCond(persistWake);
+    if (persistMutex) SDL_DestroyMutex(persistMutex);
+    persistWake = nullptr;
+    persistMutex = nullptr;
+}
+
+void queuePersistTask(std::function<void()> task)
+{
+    if (!persistThread) {
+        tasks.push_back(task);
+        return;
+    }
+    SDL_LockMutex(persistMutex);
+    tasks.push_back(task);
+    SDL_CondSignal(persistWake);
+    SDL_UnlockMutex(persistMutex);
+}
+
+void queueHighscore(int value)
+{
+    if (!persistThread) {
+        // No thread; keep the value for the write in stopPersistence().
+        pendingHighscore = value;
+        highscoreDirty = true;
+        return;
+    }
+    SDL_LockMutex(persistMutex);
+    pendingHighscore = value;
+    highscoreDirty = true;
+    SDL_CondSignal(persistWake);
+    SDL_UnlockMutex(persistMutex);
+}
@@ -0,0 +1,31 @@
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include <functional>
+#include <string>
+
+// Write-behind persistence. Game code hands over values and returns at once;
+// a background thread coalesces them and writes at most once every
+// PERSIST_INTERVAL_MS, plus a final write on shutdown.
+
+const char* const HIGHSCORE_PATH = "assets/text/highscore.txt";
+const unsigned PERSIST_INTERVAL_MS = 5000;
+
+void startPersistence();
+
+// Writes anything still pending, then stops the thread.
+void stopPersistence();
+
+// Records a new highscore to be written later. Never touches the disk.
+void queueHighscore(int value);
+
+// Runs a disk job on the persistence thread as soon as it is free, in the
+// order queued. Jobs still queued at shutdown run before stopPersistence()
+// returns.
+void queuePersistTask(std::function<void()> task);
+
+// Replaces path with contents via a temp file, fsync and rename, so a crash
+// leaves either the old or the new file, never a truncated one.
+bool writeFileAtomically(const std::string& path, const std::string& contents);
+
+#endif // PERSISTENCE_H
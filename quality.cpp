@@ -0,0 +1,108 @@
+#include "quality.h"
+#include "log.h"
+#include "softrender.h"
+
+struct QualityLevel {
+    float scale;
+    bool backgrounds;
+};
+
+static const QualityLevel LEVELS[] = {
+    { 1.0f, true },
+    { 0.75f, true },
+    { 0.5f, true },
+    { 0.5f, false },
+};
+static const int LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+// Share of the refresh interval a frame may spend; the rest is left for
+// input, game logic and the present.
+static const float BUDGET_SHARE = 0.75f;
+// Frames the average needs to settle after a change before the next one.
+static const int SETTLE_FRAMES = 30;
+// Stepping up waits for this long under RECOVER_SHARE of the budget, so one
+// quiet moment does not bounce the level straight back down.
+static const int RECOVER_FRAMES = 120;
+static const float RECOVER_SHARE = 0.45f;
+static const float AVERAGE_WEIGHT = 0.1f;
+
+static bool dynamic = true;
+static int level = 0;
+static float budgetMs = 1000.0f / 60 * BUDGET_SHARE;
+static float averageMs = 0;
+static int framesAtLevel = 0;
+static int quietFrames = 0;
+static Uint64 frameStart = 0;
+
+static void setLevel(int next)
+{
+    LOG_INFO(LOG_RENDER, "Frames take %.1f ms against a %.1f ms budget; drawing at quality level %d.",
+             averageMs, budgetMs, next);
+    level = next;
+    // Scaled copies made for the old size would never be drawn again.
+    freeScaledCopies();
+    framesAtLevel = 0;
+    quietFrames = 0;
+}
+
+void updateFrameBudget(SDL_Window* window)
+{
+    SDL_DisplayMode mode;
+    int refresh = 60;
+    if (SDL_GetWindowDisplayMode(window, &mode) == 0 && mode.refresh_rate > 0)
+        refresh = mode.refresh_rate;
+    budgetMs = 1000.0f / refresh * BUDGET_SHARE;
+    // A new window size changes the cost of everything; measure afresh.
+    averageMs = 0;
+    framesAtLevel = 0;
+    quietFrames = 0;
+}
+
+void beginFrameTiming()
+{
+    frameStart = SDL_GetPerformanceCounter();
+}
+
+void endFrameTiming()
+{
+    if (!dynamic || frameStart == 0)
+        return;
+    float ms = (float)((SDL_GetPerformanceCounter() - frameStart) * 1000.0 / SDL_GetPerformanceFrequency());
+    frameStart = 0;
+    averageMs = framesAtLevel == 0 ? ms : averageMs + (ms - averageMs) * AVERAGE_WEIGHT;
+    framesAtLevel++;
+    if (framesAtLevel < SETTLE_FRAMES)
+        return;
+
+    if (averageMs > budgetMs && level < LEVEL_COUNT - 1) {
+        setLevel(level + 1);
+        return;
+    }
+    quietFrames = averageMs < budgetMs * RECOVER_SHARE ? quietFrames + 1 : 0;
+    if (quietFrames >= RECOVER_FRAMES && level > 0)
+        setLevel(level - 1);
+}
+
+float renderScale()
+{
+    return LEVELS[level].scale;
+}
+
+bool backgroundArtEnabled()
+{
+    return LEVELS[level].backgrounds;
+}
+
+void setDynamicResolution(bool enabled)
+{
+    dynamic = enabled;
+    if (!enabled)
+        level = 0;
+}
+
+void qualityStats(int* outLevel, float* frameMs, float* outBudgetMs)
+{
+    *outLevel = level;
+    *frameMs = averageMs;
+    *outBudgetMs = budgetMs;
+}
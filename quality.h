@@ -0,0 +1,33 @@
+#ifndef QUALITY_H
+#define QUALITY_H
+
+#include <SDL.h>
+
+// Dynamic resolution. Each frame is timed from the start of recording to the
+// end of the submit; when the average runs over the frame budget the game
+// area is drawn at a lower resolution and stretched to the window, and at
+// the last step the full-window background art is left out. Levels step
+// back up once the frames have had headroom for a while.
+
+// The budget follows the display's refresh rate; call when the window
+// moves to another mode, as recomputeLayout() does.
+void updateFrameBudget(SDL_Window* window);
+
+// Brackets the work of one frame.
+void beginFrameTiming();
+void endFrameTiming();
+
+// Scale (0-1] the game area is drawn at this frame.
+float renderScale();
+
+// False at the lowest level: screens skip full-window background art.
+bool backgroundArtEnabled();
+
+// On by default; off pins full quality, as the golden images need.
+void setDynamicResolution(bool enabled);
+
+// For the diagnostics overlay: the level (0 is full quality), the averaged
+// frame cost and the budget in milliseconds.
+void qualityStats(int* level, float* frameMs, float* budgetMs);
+
+#endif // QUALITY_H
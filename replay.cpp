@@ -0,0 +1,181 @@
+#include "replay.h"
+#include "boosters.h"
+#include "game.h"
+#include "globals.h"
+#include "log.h"
+#include "persistence.h"
+#include "timers.h"
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+struct ActionName {
+    JournalAction action;
+    int arg;                // Only moves carry theirs in the name.
+    const char* name;
+};
+
+static const ActionName ACTION_NAMES[] = {
+    { JOURNAL_MOVE, SDLK_UP, "U" },
+    { JOURNAL_MOVE, SDLK_DOWN, "D" },
+    { JOURNAL_MOVE, SDLK_LEFT, "L" },
+    { JOURNAL_MOVE, SDLK_RIGHT, "R" },
+    { JOURNAL_BUY_HAMMER, 0, "buy-hammer" },
+    { JOURNAL_HAMMER_TILE, 0, "hammer" },       // Followed by the cell.
+    { JOURNAL_FREEZE, 0, "freeze" },
+    { JOURNAL_TSUNAMI, 0, "tsunami" },
+    { JOURNAL_BOOSTER_EXPIRED, 0, "booster-expired" },
+    { JOURNAL_FREEZE_EXPIRED, 0, "freeze-expired" },
+};
+
+static Replay current;
+static bool recording = false;
+
+void replayBeginGame(Uint32 seed)
+{
+    current = Replay();
+    current.seed = seed;
+    current.gridSize = GRID_SIZE;
+    recording = true;
+}
+
+void replayAction(JournalAction action, int arg)
+{
+    if (recording)
+        current.actions.push_back({ action, arg });
+}
+
+static std::string replayText(const Replay& replay)
+{
+    std::ostringstream out;
+    out << "2048 replay " << REPLAY_VERSION << "\n"
+        << "seed " << replay.seed << "\n"
+        << "size " << replay.gridSize << "\n"
+        << "score " << replay.score << "\n";
+    for (const ReplayAction& a : replay.actions) {
+        for (const ActionName& n : ACTION_NAMES) {
+            if (n.action == a.action && (a.action != JOURNAL_MOVE || n.arg == a.arg)) {
+                out << n.name;
+                if (a.action == JOURNAL_HAMMER_TILE)
+                    out << " " << a.arg;
+                out << "\n";
+                break;
+            }
+        }
+    }
+    return out.str();
+}
+
+void replayFinishGame()
+{
+    if (!recording)
+        return;
+    recording = false;
+    current.score = score;
+    std::string path = std::string(REPLAY_DIR) + "/2048-" + std::to_string(current.seed) + "-"
+                     + std::to_string(score) + ".txt";
+    std::string contents = replayText(current);
+    queuePersistTask([path, contents]() {
+#ifdef _WIN32
+        _mkdir(REPLAY_DIR);
+#else
+        mkdir(REPLAY_DIR, 0755);
+#endif
+        if (!writeFileAtomically(path, contents))
+            LOG_ERROR(LOG_SAVE, "Failed to write %s", path.c_str());
+    });
+    LOG_DEBUG(LOG_SAVE, "Replay of %u actions saved as %s.", (unsigned)current.actions.size(), path.c_str());
+}
+
+bool loadReplay(const std::string& path, Replay& replay)
+{
+    std::ifstream in(path);
+    std::string magic, kind, key;
+    int version = 0;
+    replay = Replay();
+    if (!(in >> magic >> kind >> version) || magic != "2048" || kind != "replay" || version != REPLAY_VERSION) {
+        LOG_ERROR(LOG_SAVE, "%s is not a version %d replay.", path.c_str(), REPLAY_VERSION);
+        return false;
+    }
+    if (!(in >> key >> replay.seed) || key != "seed" || !(in >> key >> replay.gridSize) || key != "size"
+        || !(in >> key >> replay.score) || key != "score"
+        || replay.gridSize < CLASSIC_GRID_SIZE || replay.gridSize > MAX_GRID_SIZE) {
+        LOG_ERROR(LOG_SAVE, "%s has a broken header.", path.c_str());
+        return false;
+    }
+
+    std::string name;
+    while (in >> name) {
+        const ActionName* found = nullptr;
+        for (const ActionName& n : ACTION_NAMES) {
+            if (name == n.name)
+                found = &n;
+        }
+        if (!found) {
+            LOG_ERROR(LOG_SAVE, "%s: unknown action '%s' after %u actions.", path.c_str(), name.c_str(),
+                      (unsigned)replay.actions.size());
+            return false;
+        }
+        ReplayAction a = { found->action, found->arg };
+        if (a.action == JOURNAL_HAMMER_TILE
+            && (!(in >> a.arg) || a.arg < 0 || a.arg >= replay.gridSize * replay.gridSize)) {
+            LOG_ERROR(LOG_SAVE, "%s: hammer without a cell on the board.", path.c_str());
+            return false;
+        }
+        replay.actions.push_back(a);
+    }
+    return true;
+}
+
+// Mirrors what the live handlers do to the board and score, in the same
+// order of gameRandom() calls.
+void applyReplayAction(const ReplayAction& a)
+{
+    switch (a.action) {
+        case JOURNAL_MOVE:
+            step_board((SDL_Keycode)a.arg);
+            break;
+        case JOURNAL_BUY_HAMMER:
+            score -= hammerButton.cost;
+            currentBoosterType = BOOSTER_HAMMER;
+            hammerActive = true;
+            break;
+        case JOURNAL_HAMMER_TILE:
+            grid[a.arg / GRID_SIZE][a.arg % GRID_SIZE] = 0;
+            if (freezeActive)
+                currentBoosterType = BOOSTER_FREEZE;
+            hammerActive = false;
+            break;
+        case JOURNAL_FREEZE:
+            score -= freezeButton.cost;
+            currentBoosterType = BOOSTER_FREEZE;
+            if (!freezeActive) {
+                freezeActive = true;
+                scheduleTimer(TIMER_FREEZE, FREEZE_DURATION, freezeExpired);
+            }
+            break;
+        case JOURNAL_TSUNAMI:
+            score -= tsunamiButton.cost;
+            currentBoosterType = freezeActive ? BOOSTER_FREEZE : BOOSTER_TSUNAMI;
+            for (int i = 0; i < GRID_SIZE; i++) {
+                for (int j = 0; j < GRID_SIZE; j++) {
+                    grid[i][j] = 0;
+                }
+            }
+            add_random_tile();
+            break;
+        case JOURNAL_BOOSTER_EXPIRED:
+            boosterActive = false;
+            cancelTimer(TIMER_BOOSTER);
+            break;
+        case JOURNAL_FREEZE_EXPIRED:
+            freezeActive = false;
+            cancelTimer(TIMER_FREEZE);
+            break;
+    }
+}
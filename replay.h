@@ -0,0 +1,47 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "session.h"
+
+// Recorded games. A replay is the seed a game was dealt from plus every
+// action taken in it, in order; all of a game's randomness comes from the
+// seed, so applying the actions to a board dealt from it plays the same
+// game again. One is written to REPLAY_DIR for every game that ends. A game
+// resumed from a saved session is not recorded, as its random state is gone.
+//
+// The file is text: a "2048 replay" line with the format version, then
+// seed, size and score lines, then one action per line (U, D, L, R for
+// moves; see ACTION_NAMES in replay.cpp for the rest).
+
+const char* const REPLAY_DIR = "replays";
+const int REPLAY_VERSION = 2;
+
+struct ReplayAction {
+    JournalAction action;
+    int arg;                // Move key, or the cell a hammer cleared.
+};
+
+struct Replay {
+    Uint32 seed;
+    int gridSize;
+    int score;              // Final score as played, to check a replay against.
+    std::vector<ReplayAction> actions;
+};
+
+// Called by initialize_grid() and journalAction().
+void replayBeginGame(Uint32 seed);
+void replayAction(JournalAction action, int arg);
+
+// Writes the game's replay on the persistence thread.
+void replayFinishGame();
+
+bool loadReplay(const std::string& path, Replay& replay);
+
+// Applies an action to the game globals by the game rules, with no sound,
+// saving or history. Timers are armed but left to the caller to run.
+void applyReplayAction(const ReplayAction& action);
+
+#endif // REPLAY_H
@@ -0,0 +1,170 @@
+#include "screens.h"
+#include "audio.h"
+#include "game.h"
+#include "globals.h"
+#include "graphics.h"
+#include "input.h"
+#include "log.h"
+#include "marathon.h"
+#include "quality.h"
+#include "textures.h"
+#include "timers.h"
+#include <vector>
+
+// Machines with less RAM than this release screen resources on exit.
+static const int LOW_MEMORY_RAM_MB = 2048;
+
+struct Screen {
+    const char* name;
+    void (*enter)();
+    void (*exit)();
+    void (*update)();
+    void (*render)(SDL_Renderer* renderer);
+    // Lazily loaded textures the screen shows.
+    void (*resources)(std::vector<LazyTexture*>& textures);
+};
+
+static UiScreen current = UI_SCREEN_START;
+static bool lowMemory = false;
+
+static bool memoryTight()
+{
+    return lowMemory || SDL_GetSystemRAM() < LOW_MEMORY_RAM_MB;
+}
+
+static void noHook() {}
+
+static void noResources(std::vector<LazyTexture*>&) {}
+
+static void enterGame()
+{
+    resumeTimers();
+}
+
+static void exitGame()
+{
+    // Countdowns stand still and buffered moves are dropped off the board.
+    pauseTimers();
+    clearMoveInputs();
+}
+
+static void updateGame()
+{
+    // One buffered move per frame; anything left over waits for the next.
+    applyQueuedMove();
+}
+
+static void gameResources(std::vector<LazyTexture*>& textures)
+{
+    textures.push_back(recordBackground);
+}
+
+static void enterGameOver()
+{
+    stopMusic();
+    playGameOverSFX();
+}
+
+static void gameOverResources(std::vector<LazyTexture*>& textures)
+{
+    if (gameoverTextures.count(currentGameoverIndex))
+        textures.push_back(gameoverTextures[currentGameoverIndex]);
+}
+
+static void enterWin()
+{
+    playGameWinMusic();
+}
+
+static void winResources(std::vector<LazyTexture*>& textures)
+{
+    if (gamewinTextures.count(currentWinIndex))
+        textures.push_back(gamewinTextures[currentWinIndex]);
+}
+
+static void exitHelp()
+{
+    if (memoryTight())
+        freeHelpPage();
+}
+
+static void exitCredits()
+{
+    if (memoryTight())
+        freeCreditsPage();
+}
+
+static const Screen screens[UI_SCREEN_COUNT] = {
+    { "start", noHook, noHook, noHook,
+      [](SDL_Renderer* r) { draw_start_screen(r); }, noResources },
+    { "game", enterGame, exitGame, updateGame,
+      [](SDL_Renderer* r) { draw_grid(r, smallFont); }, gameResources },
+    { "options", noHook, noHook, noHook,
+      [](SDL_Renderer* r) { draw_options_screen(r, buttonFont, titleFont); }, noResources },
+    { "help", noHook, exitHelp, noHook,
+      [](SDL_Renderer* r) { draw_help_screen(r, titleFont, smallFont); }, noResources },
+    { "credits", noHook, exitCredits, noHook,
+      [](SDL_Renderer* r) { draw_credits_screen(r, titleFont, smallFont, buttonFont); }, noResources },
+    { "gameover", enterGameOver, noHook, noHook,
+      [](SDL_Renderer* r) { draw_game_over_screen(r, titleFont, smallFont); }, gameOverResources },
+    { "win", enterWin, noHook, noHook,
+      [](SDL_Renderer* r) { draw_win_screen(r, titleFont, smallFont); }, winResources },
+    { "marathon", noHook, noHook, updateMarathon,
+      [](SDL_Renderer* r) { draw_marathon_screen(r, smallFont); }, noResources },
+};
+
+UiScreen currentScreen()
+{
+    return current;
+}
+
+void changeScreen(UiScreen next)
+{
+    if (next == current)
+        return;
+    LOG_DEBUG(LOG_APP, "Screen %s -> %s", screens[current].name, screens[next].name);
+
+    const Screen& from = screens[current];
+    from.exit();
+    if (memoryTight()) {
+        std::vector<LazyTexture*> leaving;
+        from.resources(leaving);
+        for (LazyTexture* texture : leaving) {
+            releaseTexture(texture);
+        }
+    }
+
+    current = next;
+    const Screen& to = screens[current];
+    std::vector<LazyTexture*> arriving;
+    to.resources(arriving);
+    for (LazyTexture* texture : arriving) {
+        prefetchTexture(texture);
+    }
+    to.enter();
+}
+
+void updateScreen()
+{
+    screens[current].update();
+}
+
+void renderScreen(SDL_Renderer* renderer)
+{
+    beginFrameTiming();
+    screens[current].render(renderer);
+}
+
+bool gameInProgress()
+{
+    // The marathon's boards are never saved; the globals hold whichever ran last.
+    return current != UI_SCREEN_START && current != UI_SCREEN_GAMEOVER
+        && current != UI_SCREEN_MARATHON && !is_game_over();
+}
+
+void noteLowMemory()
+{
+    if (!lowMemory)
+        LOG_WARN(LOG_APP, "System reported low memory; releasing screen resources on exit.");
+    lowMemory = true;
+}
@@ -0,0 +1,28 @@
+#ifndef SCREENS_H
+#define SCREENS_H
+
+#include <SDL.h>
+#include "ui.h"
+
+// The screen state machine. Exactly one screen is current; changeScreen()
+// runs the old screen's exit hook and the new one's enter hook. Each frame
+// the current screen is updated once and rendered once.
+//
+// Screens name the lazily loaded textures they show. They are paged in on
+// enter and, when memory is tight, released again on exit.
+
+UiScreen currentScreen();
+
+void changeScreen(UiScreen next);
+
+void updateScreen();
+
+void renderScreen(SDL_Renderer* renderer);
+
+// True while a board is being played (or paused in a menu).
+bool gameInProgress();
+
+// Called on SDL_APP_LOWMEMORY; from then on screens release on exit.
+void noteLowMemory();
+
+#endif // SCREENS_H
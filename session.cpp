@@ -0,0 +1,440 @@
+#include "session.h"
+#include "boosters.h"
+#include "game.h"
+#include "globals.h"
+#include "history.h"
+#include "persistence.h"
+#include "replay.h"
+#include "screens.h"
+#include "spsc.h"
+#include "timers.h"
+#include "log.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+const char SESSION_MAGIC[8] = { '2', '0', '4', '8', 'S', 'A', 'V', '\0' };
+const Uint32 SESSION_VERSION = 3;
+const Uint16 NO_CELL = 0xFFFF;
+
+enum SessionFlag {
+    SESSION_BOOSTER_ACTIVE = 1 << 0,
+    SESSION_FREEZE_ACTIVE  = 1 << 1,
+    SESSION_HAMMER_ACTIVE  = 1 << 2,
+    SESSION_LOCK_2048      = 1 << 3,
+    SESSION_CONGRATS_SHOWN = 1 << 4
+};
+
+struct SessionSnapshot {
+    char magic[8];
+    Uint32 version;
+    Uint32 nextSequence;        // First journal record not included.
+    Uint32 gridSize;
+    Uint8 cells[MAX_GRID_SIZE][MAX_GRID_SIZE];
+    Sint32 score;
+    Uint32 flags;
+    Uint32 boosterActivatedMask;    // Bit n set if the 2^n booster was used.
+    Sint32 boosterMultiplier;
+    Uint32 boosterDuration;
+    Uint32 boosterRemaining;
+    Uint32 freezeRemaining;
+    Sint32 currentBoosterType;
+    Sint32 gameoverIndex;
+    Sint32 winIndex;
+    GameRecord stats;           // History counters so far.
+    Uint32 elapsedMs;
+    Uint32 check;
+};
+
+// Fixed size so the journal can be read back as an array; check catches a
+// record torn by a crash mid-write.
+struct JournalRecord {
+    Uint32 sequence;
+    Uint8 action;
+    Uint8 spawnValue;
+    Uint16 spawnCell;
+    Uint16 blockerCell;
+    Uint16 reserved;
+    Sint32 arg;
+    Uint32 boosterRemaining;
+    Uint32 freezeRemaining;
+    Uint32 check;
+};
+
+enum SessionItemKind {
+    ITEM_RECORD,
+    ITEM_SNAPSHOT,
+    ITEM_CLEAR
+};
+
+struct SessionItem {
+    SessionItemKind kind;
+    JournalRecord record;
+    SessionSnapshot snapshot;
+};
+
+static SpscQueue<SessionItem, 1024> sessionItems;
+static SDL_sem* itemsReady = nullptr;
+static SDL_Thread* writerThread = nullptr;
+static SDL_atomic_t writerStopping;
+
+// Main thread only.
+static Uint32 nextSequence = 0;
+static Uint32 lastSnapshotSequence = 0;
+static bool resyncNeeded = false;
+static SessionItem scratch;
+
+static Uint32 checksum(const void* data, size_t size)
+{
+    const Uint8* bytes = (const Uint8*)data;
+    Uint32 h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ bytes[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void remainingTimers(Uint32* booster, Uint32* freeze)
+{
+    *booster = boosterActive ? timerRemaining(TIMER_BOOSTER) : 0;
+    *freeze = freezeActive ? timerRemaining(TIMER_FREEZE) : 0;
+}
+
+// A flag still set with nothing remaining expires on the next loop pass,
+// journaling the expiry just as a live run would have.
+static void restoreTimers(Uint32 booster, Uint32 freeze)
+{
+    if (boosterActive)
+        scheduleTimer(TIMER_BOOSTER, booster, boosterExpired);
+    else
+        cancelTimer(TIMER_BOOSTER);
+    if (freezeActive)
+        scheduleTimer(TIMER_FREEZE, freeze, freezeExpired);
+    else
+        cancelTimer(TIMER_FREEZE);
+}
+
+// O(board), no allocation.
+static void captureSnapshot(SessionSnapshot& s)
+{
+    std::memcpy(s.magic, SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    s.version = SESSION_VERSION;
+    s.nextSequence = nextSequence;
+    s.gridSize = GRID_SIZE;
+    std::memset(s.cells, 0, sizeof(s.cells));
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            s.cells[i][j] = packCell(grid[i][j]);
+        }
+    }
+    s.score = score;
+    s.flags = (boosterActive ? SESSION_BOOSTER_ACTIVE : 0)
+            | (freezeActive ? SESSION_FREEZE_ACTIVE : 0)
+            | (hammerActive ? SESSION_HAMMER_ACTIVE : 0)
+            | (lock2048 ? SESSION_LOCK_2048 : 0)
+            | (congratsShown ? SESSION_CONGRATS_SHOWN : 0);
+    s.boosterActivatedMask = 0;
+    for (const auto& pair : boosterActivated) {
+        if (pair.second)
+            s.boosterActivatedMask |= 1u << tileExponent(pair.first);
+    }
+    s.boosterMultiplier = currentBooster.multiplier;
+    s.boosterDuration = currentBooster.duration;
+    remainingTimers(&s.boosterRemaining, &s.freezeRemaining);
+    s.currentBoosterType = currentBoosterType;
+    s.gameoverIndex = currentGameoverIndex;
+    s.winIndex = currentWinIndex;
+    s.stats = currentGameStats;
+    s.elapsedMs = historyElapsedMs();
+    s.check = checksum(&s, offsetof(SessionSnapshot, check));
+}
+
+static void applySnapshot(const SessionSnapshot& s)
+{
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            grid[i][j] = unpackCell(s.cells[i][j]);
+        }
+    }
+    score = s.score;
+    boosterActive = (s.flags & SESSION_BOOSTER_ACTIVE) != 0;
+    freezeActive = (s.flags & SESSION_FREEZE_ACTIVE) != 0;
+    hammerActive = (s.flags & SESSION_HAMMER_ACTIVE) != 0;
+    tsunamiActive = false;
+    lock2048 = (s.flags & SESSION_LOCK_2048) != 0;
+    congratsShown = (s.flags & SESSION_CONGRATS_SHOWN) != 0;
+    for (const auto& pair : boosterSettings) {
+        boosterActivated[pair.first] = (s.boosterActivatedMask >> tileExponent(pair.first)) & 1;
+    }
+    currentBooster = { s.boosterMultiplier, s.boosterDuration };
+    currentBoosterType = (BoosterType)s.currentBoosterType;
+    currentGameoverIndex = s.gameoverIndex;
+    currentWinIndex = s.winIndex;
+    currentGameStats = s.stats;
+    historySetElapsedMs(s.elapsedMs);
+    restoreTimers(s.boosterRemaining, s.freezeRemaining);
+}
+
+// Mirrors what the live handlers do to the board, minus sound, cursor and
+// randomness; the random outcomes come from the record.
+static void replayRecord(const JournalRecord& r)
+{
+    switch (r.action) {
+        case JOURNAL_MOVE:
+            slide_tiles((SDL_Keycode)r.arg);
+            currentGameStats.values[HISTORY_MOVES]++;
+            break;
+        case JOURNAL_BUY_HAMMER:
+            currentGameStats.values[HISTORY_BOOSTER_USES]++;
+            score -= hammerButton.cost;
+            currentBoosterType = BOOSTER_HAMMER;
+            hammerActive = true;
+            break;
+        case JOURNAL_HAMMER_TILE:
+            grid[r.arg / GRID_SIZE][r.arg % GRID_SIZE] = 0;
+            if (freezeActive)
+                currentBoosterType = BOOSTER_FREEZE;
+            hammerActive = false;
+            break;
+        case JOURNAL_FREEZE:
+            currentGameStats.values[HISTORY_BOOSTER_USES]++;
+            score -= freezeButton.cost;
+            currentBoosterType = BOOSTER_FREEZE;
+            freezeActive = true;
+            break;
+        case JOURNAL_TSUNAMI:
+            currentGameStats.values[HISTORY_BOOSTER_USES]++;
+            score -= tsunamiButton.cost;
+            currentBoosterType = freezeActive ? BOOSTER_FREEZE : BOOSTER_TSUNAMI;
+            for (int i = 0; i < GRID_SIZE; i++) {
+                for (int j = 0; j < GRID_SIZE; j++) {
+                    grid[i][j] = 0;
+                }
+            }
+            break;
+        case JOURNAL_BOOSTER_EXPIRED:
+            boosterActive = false;
+            break;
+        case JOURNAL_FREEZE_EXPIRED:
+            freezeActive = false;
+            break;
+    }
+    if (r.spawnCell != NO_CELL)
+        grid[r.spawnCell / GRID_SIZE][r.spawnCell % GRID_SIZE] = r.spawnValue;
+    if (r.blockerCell != NO_CELL) {
+        grid[r.blockerCell / GRID_SIZE][r.blockerCell % GRID_SIZE] = BLOCKER_VALUE;
+        currentGameStats.values[HISTORY_BLOCKERS]++;
+    }
+    restoreTimers(r.boosterRemaining, r.freezeRemaining);
+}
+
+bool restoreSession()
+{
+    SessionSnapshot snapshot;
+    FILE* file = std::fopen(SESSION_SNAPSHOT_PATH, "rb");
+    if (!file)
+        return false;
+    bool valid = std::fread(&snapshot, sizeof(snapshot), 1, file) == 1
+        && std::memcmp(snapshot.magic, SESSION_MAGIC, sizeof(SESSION_MAGIC)) == 0
+        && snapshot.version == SESSION_VERSION
+        && snapshot.check == checksum(&snapshot, offsetof(SessionSnapshot, check));
+    std::fclose(file);
+    if (!valid) {
+        LOG_WARN(LOG_SAVE, "Ignoring damaged saved game %s", SESSION_SNAPSHOT_PATH);
+        return false;
+    }
+    if (snapshot.gridSize != (Uint32)GRID_SIZE) {
+        LOG_INFO(LOG_SAVE, "Saved game is on a %ux%u board; starting a new %dx%d game.",
+                 snapshot.gridSize, snapshot.gridSize, GRID_SIZE, GRID_SIZE);
+        return false;
+    }
+
+    Uint32 startTicks = SDL_GetTicks();
+    applySnapshot(snapshot);
+    Uint32 expected = snapshot.nextSequence;
+
+    std::vector<JournalRecord> records;
+    file = std::fopen(SESSION_JOURNAL_PATH, "rb");
+    if (file) {
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        records.resize(size > 0 ? (size_t)size / sizeof(JournalRecord) : 0);
+        records.resize(std::fread(records.data(), sizeof(JournalRecord), records.size(), file));
+        std::fclose(file);
+    }
+    for (const JournalRecord& r : records) {
+        if (r.check != checksum(&r, offsetof(JournalRecord, check)))
+            break;
+        if (r.sequence < expected)
+            continue;   // Already in the snapshot.
+        if (r.sequence != expected)
+            break;
+        replayRecord(r);
+        expected++;
+    }
+
+    nextSequence = expected;
+    lastSnapshotSequence = snapshot.nextSequence;
+    if (hammerActive)
+        SDL_SetCursor(setBoosterCursor(renderer, hammerButton));
+    LOG_INFO(LOG_SAVE, "Resumed saved game: %u journaled actions replayed in %u ms.",
+             expected - snapshot.nextSequence, SDL_GetTicks() - startTicks);
+    return true;
+}
+
+static void syncFile(FILE* file)
+{
+    std::fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+static int sessionWriter(void*)
+{
+    FILE* journal = std::fopen(SESSION_JOURNAL_PATH, "ab");
+    if (!journal)
+        LOG_ERROR(LOG_SAVE, "Cannot open %s; moves are saved by snapshot only.", SESSION_JOURNAL_PATH);
+    Uint32 lastCommit = 0;
+    SessionItem item;
+
+    while (!SDL_AtomicGet(&writerStopping) || sessionItems.size() > 0) {
+        if (SDL_SemWaitTimeout(itemsReady, SESSION_COMMIT_MS) == 0 && !SDL_AtomicGet(&writerStopping)) {
+            // Group commit: let actions gather for the rest of the window
+            // so a burst of moves shares one fsync.
+            Uint32 since = SDL_GetTicks() - lastCommit;
+            if (since < SESSION_COMMIT_MS)
+                SDL_Delay(SESSION_COMMIT_MS - since);
+        }
+
+        bool dirty = false;
+        while (sessionItems.pop(item)) {
+            switch (item.kind) {
+                case ITEM_RECORD:
+                    if (journal) {
+                        std::fwrite(&item.record, sizeof(item.record), 1, journal);
+                        dirty = true;
+                    }
+                    break;
+                case ITEM_SNAPSHOT:
+                    // The snapshot covers every record queued before it, so once
+                    // it is durable the journal can start over.
+                    if (writeFileAtomically(SESSION_SNAPSHOT_PATH,
+                                            std::string((const char*)&item.snapshot, sizeof(item.snapshot)))) {
+                        if (journal) std::fclose(journal);
+                        journal = std::fopen(SESSION_JOURNAL_PATH, "wb");
+                        dirty = false;
+                    } else {
+                        LOG_ERROR(LOG_SAVE, "Failed to write %s", SESSION_SNAPSHOT_PATH);
+                    }
+                    break;
+                case ITEM_CLEAR:
+                    if (journal) std::fclose(journal);
+                    std::remove(SESSION_SNAPSHOT_PATH);
+                    journal = std::fopen(SESSION_JOURNAL_PATH, "wb");
+                    dirty = false;
+                    break;
+            }
+        }
+        if (dirty) {
+            syncFile(journal);
+            lastCommit = SDL_GetTicks();
+        }
+    }
+    if (journal)
+        std::fclose(journal);
+    return 0;
+}
+
+static void postItem(SessionItemKind kind)
+{
+    scratch.kind = kind;
+    if (!sessionItems.push(scratch)) {
+        // The writer has fallen far behind. Drop this item and write a full
+        // snapshot as soon as there is room; it supersedes the gap.
+        resyncNeeded = true;
+        return;
+    }
+    if (itemsReady)
+        SDL_SemPost(itemsReady);
+}
+
+static void postSnapshot()
+{
+    captureSnapshot(scratch.snapshot);
+    lastSnapshotSequence = nextSequence;
+    resyncNeeded = false;
+    postItem(ITEM_SNAPSHOT);
+}
+
+void startSession()
+{
+    if (writerThread)
+        return;
+    SDL_AtomicSet(&writerStopping, 0);
+    itemsReady = SDL_CreateSemaphore(0);
+    writerThread = SDL_CreateThread(sessionWriter, "SessionWriter", nullptr);
+    if (!writerThread)
+        LOG_ERROR(LOG_SAVE, "Failed to start session writer: %s", SDL_GetError());
+    // Compact whatever was just restored into a fresh snapshot.
+    if (gameInProgress())
+        postSnapshot();
+}
+
+void stopSession()
+{
+    if (!writerThread)
+        return;
+    if (gameInProgress())
+        postSnapshot();
+    SDL_AtomicSet(&writerStopping, 1);
+    SDL_SemPost(itemsReady);
+    SDL_WaitThread(writerThread, nullptr);
+    writerThread = nullptr;
+    SDL_DestroySemaphore(itemsReady);
+    itemsReady = nullptr;
+}
+
+void journalAction(JournalAction action, int arg, int spawnCell, int blockerCell)
+{
+    replayAction(action, arg);
+    if (resyncNeeded || nextSequence - lastSnapshotSequence >= SESSION_SNAPSHOT_INTERVAL) {
+        nextSequence++;
+        postSnapshot();
+        return;
+    }
+
+    JournalRecord& r = scratch.record;
+    r.sequence = nextSequence++;
+    r.action = (Uint8)action;
+    r.arg = arg;
+    r.spawnCell = spawnCell >= 0 ? (Uint16)spawnCell : NO_CELL;
+    r.spawnValue = spawnCell >= 0 ? (Uint8)grid[spawnCell / GRID_SIZE][spawnCell % GRID_SIZE] : 0;
+    r.blockerCell = blockerCell >= 0 ? (Uint16)blockerCell : NO_CELL;
+    r.reserved = 0;
+    remainingTimers(&r.boosterRemaining, &r.freezeRemaining);
+    r.check = checksum(&r, offsetof(JournalRecord, check));
+    postItem(ITEM_RECORD);
+}
+
+void sessionNewGame()
+{
+    postSnapshot();
+}
+
+void sessionEnd()
+{
+    resyncNeeded = false;
+    postItem(ITEM_CLEAR);
+}
@@ -0,0 +1,49 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <SDL.h>
+
+// Crash-safe save of the game in progress. A snapshot of the whole game is
+// written on a new game, every SESSION_SNAPSHOT_INTERVAL actions and at exit;
+// each action in between is appended to a journal that a background thread
+// commits in batches. On launch the snapshot is loaded and the journal tail
+// replayed on top of it.
+//
+// Timers are stored as time remaining, never as SDL_GetTicks values, so they
+// resume where they stopped.
+
+const char* const SESSION_SNAPSHOT_PATH = "assets/text/session.snap";
+const char* const SESSION_JOURNAL_PATH = "assets/text/session.journal";
+const Uint32 SESSION_SNAPSHOT_INTERVAL = 256;
+// Longest a committed action can wait for its fsync.
+const Uint32 SESSION_COMMIT_MS = 250;
+
+enum JournalAction {
+    JOURNAL_MOVE = 1,           // arg = key; spawned tile and blocker cells.
+    JOURNAL_BUY_HAMMER,
+    JOURNAL_HAMMER_TILE,        // arg = cell cleared.
+    JOURNAL_FREEZE,
+    JOURNAL_TSUNAMI,            // Spawned tile cell.
+    JOURNAL_BOOSTER_EXPIRED,
+    JOURNAL_FREEZE_EXPIRED
+};
+
+// Loads the saved game, if any, into the globals. Call before startSession().
+bool restoreSession();
+
+void startSession();
+
+// Saves a final snapshot of an unfinished game and stops the writer.
+void stopSession();
+
+// Records an action that has just been applied to the board. Cells are
+// row * GRID_SIZE + col, or -1. Never blocks.
+void journalAction(JournalAction action, int arg = 0, int spawnCell = -1, int blockerCell = -1);
+
+// A fresh board replaces the saved game.
+void sessionNewGame();
+
+// The game is over; nothing is left to resume.
+void sessionEnd();
+
+#endif // SESSION_H
@@ -0,0 +1,205 @@
+#include "softrender.h"
+#include "globals.h"
+#include "log.h"
+#include "textures.h"
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// The window is compared against the last frame in blocks this size.
+static const int DIRTY_BLOCK = 64;
+static const Uint32 SOFTWARE_FRAME_MS = 16;
+
+struct ScaledCopy {
+    SDL_Texture* texture;
+    size_t bytes;
+};
+
+static bool software = false;
+static std::map<std::tuple<SDL_Texture*, int, int>, ScaledCopy> scaledCopies;
+static std::vector<Uint8> lastFrame;
+static int lastFrameW = 0;
+static int lastFrameH = 0;
+static int lastRectCount = 0;
+static int lastPercent = 0;
+static Uint32 nextFrameTicks = 0;
+static bool pacing = true;
+
+SDL_Renderer* createGameRenderer(SDL_Window* window, bool forceSoftware)
+{
+    if (!forceSoftware) {
+        SDL_Renderer* gpu = SDL_CreateRenderer(window, -1,
+            SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        SDL_RendererInfo info;
+        if (gpu && SDL_GetRendererInfo(gpu, &info) == 0 && !(info.flags & SDL_RENDERER_SOFTWARE)) {
+            LOG_INFO(LOG_RENDER, "Rendering with %s.", info.name);
+            return gpu;
+        }
+        if (gpu)
+            SDL_DestroyRenderer(gpu);
+    }
+    software = true;
+    LOG_INFO(LOG_RENDER, "No GPU renderer; drawing to the window surface.");
+    return SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE);
+}
+
+bool softwareRendering()
+{
+    return software;
+}
+
+static SDL_Texture* makeScaledCopy(SDL_Renderer* renderer, SDL_Texture* texture, int w, int h)
+{
+    Uint32 format = 0;
+    SDL_BlendMode blend = SDL_BLENDMODE_NONE;
+    SDL_QueryTexture(texture, &format, nullptr, nullptr, nullptr);
+    SDL_GetTextureBlendMode(texture, &blend);
+    // Opaque art takes the window's own format so the per-frame blit is a copy.
+    bool opaque = !SDL_ISPIXELFORMAT_ALPHA(format) || blend == SDL_BLENDMODE_NONE;
+    Uint32 copyFormat = opaque ? SDL_GetWindowPixelFormat(window) : SDL_PIXELFORMAT_ARGB8888;
+
+    SDL_Texture* copy = SDL_CreateTexture(renderer, copyFormat, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!copy)
+        return nullptr;
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, copy);
+    SDL_SetTextureBlendMode(copy, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    SDL_SetTextureBlendMode(texture, blend);
+    SDL_SetRenderTarget(renderer, previousTarget);
+    SDL_SetTextureBlendMode(copy, opaque ? SDL_BLENDMODE_NONE : blend);
+    return copy;
+}
+
+void drawScaled(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect& dest)
+{
+    if (!texture)
+        return;
+    if (!software) {
+        SDL_RenderCopy(renderer, texture, nullptr, &dest);
+        return;
+    }
+    auto key = std::make_tuple(texture, dest.w, dest.h);
+    auto it = scaledCopies.find(key);
+    if (it == scaledCopies.end()) {
+        SDL_Texture* copy = makeScaledCopy(renderer, texture, dest.w, dest.h);
+        if (!copy) {
+            SDL_RenderCopy(renderer, texture, nullptr, &dest);
+            return;
+        }
+        ScaledCopy entry = { copy, textureSizeBytes(copy) };
+        trackTextureBytes(TEXTURE_BACKGROUND, entry.bytes);
+        it = scaledCopies.emplace(key, entry).first;
+    }
+    SDL_RenderCopy(renderer, it->second.texture, nullptr, &dest);
+}
+
+void freeScaledCopies()
+{
+    for (auto& kv : scaledCopies) {
+        SDL_DestroyTexture(kv.second.texture);
+        untrackTextureBytes(TEXTURE_BACKGROUND, kv.second.bytes);
+    }
+    scaledCopies.clear();
+}
+
+// Compares the surface with the last presented frame and collects changed
+// blocks, merging runs along each block row.
+static void collectDirtyRects(SDL_Surface* surface, std::vector<SDL_Rect>& rects)
+{
+    int rowBytes = surface->w * surface->format->BytesPerPixel;
+    if (surface->w != lastFrameW || surface->h != lastFrameH) {
+        lastFrame.assign((size_t)rowBytes * surface->h, 0);
+        lastFrameW = surface->w;
+        lastFrameH = surface->h;
+        rects.push_back({ 0, 0, surface->w, surface->h });
+        for (int y = 0; y < surface->h; y++) {
+            std::memcpy(&lastFrame[(size_t)y * rowBytes], (Uint8*)surface->pixels + y * surface->pitch, rowBytes);
+        }
+        return;
+    }
+
+    int bpp = surface->format->BytesPerPixel;
+    for (int by = 0; by < surface->h; by += DIRTY_BLOCK) {
+        int bh = SDL_min(DIRTY_BLOCK, surface->h - by);
+        int runStart = -1;
+        for (int bx = 0; bx < surface->w + DIRTY_BLOCK; bx += DIRTY_BLOCK) {
+            bool changed = false;
+            if (bx < surface->w) {
+                int spanBytes = SDL_min(DIRTY_BLOCK, surface->w - bx) * bpp;
+                for (int y = by; y < by + bh; y++) {
+                    Uint8* now = (Uint8*)surface->pixels + y * surface->pitch + bx * bpp;
+                    Uint8* before = &lastFrame[(size_t)y * rowBytes + bx * bpp];
+                    if (std::memcmp(now, before, spanBytes) != 0) {
+                        // Sync the rest of the block in one pass.
+                        for (int yy = y; yy < by + bh; yy++) {
+                            std::memcpy(&lastFrame[(size_t)yy * rowBytes + bx * bpp],
+                                        (Uint8*)surface->pixels + yy * surface->pitch + bx * bpp, spanBytes);
+                        }
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+            if (changed && runStart < 0) {
+                runStart = bx;
+            } else if (!changed && runStart >= 0) {
+                rects.push_back({ runStart, by, SDL_min(bx, surface->w) - runStart, bh });
+                runStart = -1;
+            }
+        }
+    }
+}
+
+void presentRenderer(SDL_Renderer* renderer)
+{
+    if (!software) {
+        SDL_RenderPresent(renderer);
+        return;
+    }
+
+    SDL_RenderFlush(renderer);
+    SDL_Surface* surface = SDL_GetWindowSurface(window);
+    if (!surface) {
+        SDL_RenderPresent(renderer);
+        return;
+    }
+    std::vector<SDL_Rect> rects;
+    SDL_LockSurface(surface);
+    collectDirtyRects(surface, rects);
+    SDL_UnlockSurface(surface);
+
+    long long area = 0;
+    for (const SDL_Rect& r : rects) {
+        area += (long long)r.w * r.h;
+    }
+    lastRectCount = (int)rects.size();
+    lastPercent = (int)(area * 100 / ((long long)surface->w * surface->h));
+    if (!rects.empty())
+        SDL_UpdateWindowSurfaceRects(window, rects.data(), (int)rects.size());
+
+    // No vsync on this path; sleep out the rest of the frame instead.
+    if (!pacing)
+        return;
+    Uint32 now = SDL_GetTicks();
+    if ((Sint32)(nextFrameTicks - now) > 0)
+        SDL_Delay(nextFrameTicks - now);
+    else
+        nextFrameTicks = now;
+    nextFrameTicks += SOFTWARE_FRAME_MS;
+}
+
+void setSoftwarePacing(bool paced)
+{
+    pacing = paced;
+}
+
+void softwarePresentStats(int* rects, int* percent)
+{
+    *rects = lastRectCount;
+    *percent = lastPercent;
+}
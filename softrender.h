@@ -0,0 +1,34 @@
+#ifndef SOFTRENDER_H
+#define SOFTRENDER_H
+
+#include <SDL.h>
+
+// Rendering for machines without a GPU. SDL's software renderer draws
+// straight into the window surface; on top of that this module keeps
+// window-sized art pre-scaled in the window's pixel format, and presents
+// only the parts of the surface that changed since the last frame.
+
+// Creates the window's renderer: the GPU with vsync when there is one and
+// forceSoftware is false, otherwise the software path.
+SDL_Renderer* createGameRenderer(SDL_Window* window, bool forceSoftware);
+
+bool softwareRendering();
+
+// Draws a whole texture stretched to dest. On the software path the scaled
+// copy is made once per size and reused, so each frame is a plain blit.
+void drawScaled(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect& dest);
+
+// Drops the scaled copies; call on resize and before textures are freed.
+void freeScaledCopies();
+
+// Replaces SDL_RenderPresent. The software path updates only changed
+// blocks of the window and paces itself to 60 frames per second.
+void presentRenderer(SDL_Renderer* renderer);
+
+// Frame pacing is on by default; offscreen rendering turns it off.
+void setSoftwarePacing(bool paced);
+
+// Rectangles and share of the window (0-100) updated by the last present.
+void softwarePresentStats(int* rects, int* percent);
+
+#endif // SOFTRENDER_H
@@ -0,0 +1,52 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <SDL.h>
+
+// Fixed-size single-producer, single-consumer queue. push() may only be
+// called from one thread and pop() from one other thread; neither locks.
+// Capacity must be a power of two.
+template <typename T, Uint32 Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    SpscQueue()
+    {
+        SDL_AtomicSet(&head, 0);
+        SDL_AtomicSet(&tail, 0);
+    }
+
+    // Returns false, dropping the item, if the queue is full.
+    bool push(const T& item)
+    {
+        Uint32 t = (Uint32)SDL_AtomicGet(&tail);
+        if (t - (Uint32)SDL_AtomicGet(&head) == Capacity)
+            return false;
+        items[t & (Capacity - 1)] = item;
+        SDL_AtomicSet(&tail, (int)(t + 1));
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        Uint32 h = (Uint32)SDL_AtomicGet(&head);
+        if (h == (Uint32)SDL_AtomicGet(&tail))
+            return false;
+        item = items[h & (Capacity - 1)];
+        SDL_AtomicSet(&head, (int)(h + 1));
+        return true;
+    }
+
+    Uint32 size()
+    {
+        return (Uint32)SDL_AtomicGet(&tail) - (Uint32)SDL_AtomicGet(&head);
+    }
+
+private:
+    T items[Capacity];
+    SDL_atomic_t head;   // Written by the consumer.
+    SDL_atomic_t tail;   // Written by the producer.
+};
+
+#endif // SPSC_H
@@ -1,93 +1,188 @@
 #include "textures.h"
 #include "globals.h"
+#include "assets.h"
+#include "log.h"
 #include <SDL_image.h>
-#include <iostream>
 #include <string>
 #include <map>
 
-bool loadAllTextures(SDL_Renderer* renderer)
+// Textures drawn this recently count as on screen and are not evicted. Longer
+// than the main loop's idle sleep, so a static screen keeps its art.
+static const Uint32 EVICT_GRACE_MS = 1000;
+
+static const char* const CATEGORY_NAMES[TEXTURE_CATEGORY_COUNT] = {
+    "bg", "fruit", "end", "ui", "text"
+};
+
+static std::map<std::string, LazyTexture> textureCache;
+static size_t categoryBytes[TEXTURE_CATEGORY_COUNT];
+static size_t budgetBytes = (size_t)DEFAULT_TEXTURE_BUDGET_MB * 1024 * 1024;
+static bool warnedOverBudget = false;
+
+size_t textureSizeBytes(SDL_Texture* texture)
+{
+    Uint32 format = 0;
+    int w = 0, h = 0;
+    if (!texture || SDL_QueryTexture(texture, &format, nullptr, &w, &h) != 0)
+        return 0;
+    int bytesPerPixel = SDL_BYTESPERPIXEL(format);
+    return (size_t)w * h * (bytesPerPixel ? bytesPerPixel : 4);
+}
+
+size_t totalTextureBytes()
+{
+    size_t total = 0;
+    for (size_t bytes : categoryBytes) {
+        total += bytes;
+    }
+    return total;
+}
+
+// Evicts the least recently used unpinned textures until the total fits.
+static void enforceBudget()
+{
+    Uint32 now = SDL_GetTicks();
+    while (totalTextureBytes() > budgetBytes) {
+        LazyTexture* victim = nullptr;
+        for (auto& kv : textureCache) {
+            LazyTexture& handle = kv.second;
+            if (!handle.texture || handle.pinned || now - handle.lastUsed < EVICT_GRACE_MS)
+                continue;
+            if (!victim || handle.lastUsed < victim->lastUsed)
+                victim = &handle;
+        }
+        if (!victim) {
+            if (!warnedOverBudget)
+                LOG_WARN(LOG_RENDER, "Textures need %zu KB, over the %zu KB budget, and none can be evicted.",
+                         totalTextureBytes() / 1024, budgetBytes / 1024);
+            warnedOverBudget = true;
+            return;
+        }
+        LOG_DEBUG(LOG_RENDER, "Evicting %s (%zu KB)", victim->path.c_str(), victim->bytes / 1024);
+        releaseTexture(victim);
+    }
+    warnedOverBudget = false;
+}
+
+void trackTextureBytes(TextureCategory category, size_t bytes)
+{
+    categoryBytes[category] += bytes;
+    enforceBudget();
+}
+
+void untrackTextureBytes(TextureCategory category, size_t bytes)
+{
+    categoryBytes[category] -= SDL_min(bytes, categoryBytes[category]);
+}
+
+void setTextureBudget(size_t bytes)
+{
+    budgetBytes = bytes;
+    enforceBudget();
+}
+
+size_t textureBudget()
+{
+    return budgetBytes;
+}
+
+size_t textureBytes(TextureCategory category)
 {
-    SDL_Surface* startSurface = IMG_Load("assets/backgrounds and textures/startbg.png");
-    if (!startSurface)
-        std::cerr << "Failed to load start PNG file: " << IMG_GetError() << "\n";
+    return categoryBytes[category];
+}
 
-    SDL_Surface* sidebarSurface = IMG_Load("assets/backgrounds and textures/sidebar.png");
-    if (!sidebarSurface){
-        std::cerr << "Failed to load sidebar PNG file: " << IMG_GetError() << "\n";
+const char* textureCategoryName(TextureCategory category)
+{
+    return CATEGORY_NAMES[category];
+}
+
+LazyTexture* textureHandle(const std::string& path, TextureCategory category)
+{
+    LazyTexture& handle = textureCache[path];
+    if (handle.path.empty()) {
+        handle.path = path;
+        handle.category = category;
+    }
+    return &handle;
+}
+
+void prefetchTexture(LazyTexture* handle)
+{
+    if (!handle || handle->requested)
+        return;
+    handle->requested = true;
+    requestTexture(handle->path, [handle](SDL_Texture* tex) {
+        handle->texture = tex;
+        handle->bytes = textureSizeBytes(tex);
+        handle->lastUsed = SDL_GetTicks();
+        for (auto &callback : handle->onReady) {
+            callback(tex);
+        }
+        handle->onReady.clear();
+        trackTextureBytes(handle->category, handle->bytes);
+    });
+}
+
+SDL_Texture* useTexture(LazyTexture* handle)
+{
+    if (!handle)
+        return nullptr;
+    if (!handle->texture)
+        prefetchTexture(handle);
+    handle->lastUsed = SDL_GetTicks();
+    return handle->texture;
+}
+
+void releaseTexture(LazyTexture* handle)
+{
+    if (!handle || !handle->texture)
+        return;
+    SDL_DestroyTexture(handle->texture);
+    untrackTextureBytes(handle->category, handle->bytes);
+    handle->texture = nullptr;
+    handle->bytes = 0;
+    handle->requested = false;
+}
+
+void loadPinnedTexture(const std::string& path, TextureCategory category,
+                       std::function<void(SDL_Texture*)> assign)
+{
+    LazyTexture* handle = textureHandle(path, category);
+    handle->pinned = true;
+    if (handle->texture) {
+        assign(handle->texture);
+        return;
+    }
+    handle->onReady.push_back(assign);
+    prefetchTexture(handle);
+}
+
+bool loadAllTextures(SDL_Renderer* renderer)
+{
+    // Decoding happens on the asset workers in request order, so the start
+    // screen background goes first and the first frame can show it.
+    struct TextureSlot {
+        const char* path;
+        TextureCategory category;
+        SDL_Texture** slot;
+    };
+    const TextureSlot slots[] = {
+        { "assets/backgrounds and textures/startbg.png",    TEXTURE_BACKGROUND, &startBackground },
+        { "assets/backgrounds and textures/gamegridbg.jpg", TEXTURE_BACKGROUND, &gridBackground },
+        { "assets/backgrounds and textures/sidebar.png",    TEXTURE_BACKGROUND, &sidebarBackground },
+        { "assets/backgrounds and textures/cloud.png",      TEXTURE_UI,         &scoreBackground },
+        { "assets/backgrounds and textures/cloud.png",      TEXTURE_UI,         &cloudTexture },
+        { "assets/backgrounds and textures/blocker.png",    TEXTURE_FRUIT,      &blockerTexture },
+        { "assets/backgrounds and textures/musicbar.png",   TEXTURE_UI,         &musicbarTexture },
+        { "assets/backgrounds and textures/appletoggle.png", TEXTURE_UI,        &musictoggleTexture },
+        { "assets/backgrounds and textures/optionsbg.jpg",  TEXTURE_BACKGROUND, &optionBackground },
+        { "assets/backgrounds and textures/optionsbg.jpg",  TEXTURE_BACKGROUND, &gameoverBackground },
+        { "assets/backgrounds and textures/optionsbg.jpg",  TEXTURE_BACKGROUND, &gamewonBackground },
+    };
+    for (const auto &s : slots) {
+        SDL_Texture** slot = s.slot;
+        loadPinnedTexture(s.path, s.category, [slot](SDL_Texture* tex) { *slot = tex; });
     }
-    SDL_Surface* scoreSurface = IMG_Load("assets/backgrounds and textures/cloud.png");
-    if (!scoreSurface)
-        std::cerr << "Failed to load score PNG file: " << IMG_GetError() << "\n";
-
-    SDL_Surface* cloudSurface = IMG_Load("assets/backgrounds and textures/cloud.png");
-    if (!cloudSurface)
-        std::cerr << "Failed to load cloud PNG file: " << IMG_GetError() << "\n";
-
-    SDL_Surface* blockerSurface = IMG_Load("assets/backgrounds and textures/blocker.png");
-    if (!blockerSurface)
-        std::cerr << "Failed to load blocker image: " << IMG_GetError() << "\n";
-
-    SDL_Surface* musicbarSurface = IMG_Load("assets/backgrounds and textures/musicbar.png");
-    if (!musicbarSurface)
-        std::cerr << "Failed to load music bar PNG file: " << IMG_GetError() << "\n";
-
-    SDL_Surface* musictoggleSurface = IMG_Load("assets/backgrounds and textures/appletoggle.png");
-    if (!musictoggleSurface)
-        std::cerr << "Failed to load music toggle PNG file: " << IMG_GetError() << "\n";
-
-    recordBackground = IMG_LoadTexture(renderer, "assets/backgrounds and textures/newrec.jpg");
-    if (!recordBackground)
-        std::cerr << "Failed to load record background: " << IMG_GetError() << "\n";
-
-    gridBackground = IMG_LoadTexture(renderer, "assets/backgrounds and textures/gamegridbg.jpg");
-    if (!gridBackground)
-        std::cerr << "Failed to load grid background: " << IMG_GetError() << "\n";
-
-    optionBackground = IMG_LoadTexture(renderer, "assets/backgrounds and textures/optionsbg.jpg");
-    if (!optionBackground)
-        std::cerr << "Failed to load option background: " << IMG_GetError() << "\n";
-
-    gameoverBackground = IMG_LoadTexture(renderer, "assets/backgrounds and textures/optionsbg.jpg");
-    if (!gameoverBackground)
-        std::cerr << "Failed to load game over background: " << IMG_GetError() << "\n";
-
-    gamewonBackground = IMG_LoadTexture(renderer, "assets/backgrounds and textures/optionsbg.jpg");
-    if (!gamewonBackground)
-        std::cerr << "Failed to load game won background: " << IMG_GetError() << "\n";
-
-    startBackground = SDL_CreateTextureFromSurface(renderer, startSurface);
-    SDL_FreeSurface(startSurface);
-    if (!startBackground)
-        std::cerr << "Failed to create start background texture: " << SDL_GetError() << "\n";
-
-    sidebarBackground = SDL_CreateTextureFromSurface(renderer, sidebarSurface);
-    SDL_FreeSurface(sidebarSurface);
-    if (!sidebarBackground)
-        std::cerr << "Failed to create sidebar background texture: " << SDL_GetError() << "\n";
-
-    scoreBackground = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-    SDL_FreeSurface(scoreSurface);
-    if (!scoreBackground)
-        std::cerr << "Failed to load score background: " << SDL_GetError() << "\n";
-
-    blockerTexture = SDL_CreateTextureFromSurface(renderer, blockerSurface);
-    if (!blockerSurface)
-        std::cerr << "Failed to load blocker background: " << SDL_GetError() << "\n";
-
-    cloudTexture = SDL_CreateTextureFromSurface(renderer, cloudSurface);
-    SDL_FreeSurface(cloudSurface);
-    if (!cloudTexture)
-        std::cerr << "Failed to create cloud texture: " << SDL_GetError() << "\n";
-
-    musicbarTexture = SDL_CreateTextureFromSurface(renderer, musicbarSurface);
-    SDL_FreeSurface(musicbarSurface);
-    if (!musicbarTexture)
-        std::cerr << "Failed to create music bar texture: " << SDL_GetError() << "\n";
-
-    musictoggleTexture = SDL_CreateTextureFromSurface(renderer, musictoggleSurface);
-    SDL_FreeSurface(musictoggleSurface);
-    if (!musictoggleTexture)
-        std::cerr << "Failed to create music toggle texture: " << SDL_GetError() << "\n";
 
     std::string fruitNames[] = {
         "apple", "banana", "dragonfruit", "grape", "mango",
@@ -97,86 +192,51 @@ bool loadAllTextures(SDL_Renderer* renderer)
 
     for (int i = 0; i < 11; i++) {
         std::string path = "assets/Fruit/" + fruitNames[i] + ".jpg";
-        SDL_Surface* surf = IMG_Load(path.c_str());
-        if (!surf) {
-            std::cerr << "Failed to load " << path << ": " << IMG_GetError() << "\n";
-            continue;
-        }
-        fruitTextures[fruitValues[i]] = SDL_CreateTextureFromSurface(renderer, surf);
-        SDL_FreeSurface(surf);
+        int value = fruitValues[i];
+        loadPinnedTexture(path, TEXTURE_FRUIT, [value](SDL_Texture* tex) {
+            if (tex) fruitTextures[value] = tex;
+        });
     }
 
+    // Shown only on a new record, a win or a loss: register handles and let
+    // useTexture()/prefetchTexture() bring them in.
+    recordBackground = textureHandle("assets/backgrounds and textures/newrec.jpg", TEXTURE_END_SCREEN);
     for (int i = 0; i < 5; i++){
-        std::string path = "assets/backgrounds and textures/gameover/gameoverbg" + std::to_string(i+1) + ".png";
-        SDL_Surface* surf = IMG_Load(path.c_str());
-        if (!surf){
-            std::cerr << "Failed to load " << path << ": " << IMG_GetError() << "\n";
-            continue;
-        }
-        gameoverTextures[i+1] = SDL_CreateTextureFromSurface(renderer, surf);
-        SDL_FreeSurface(surf);
-    }
-
-    for (int i = 0; i < 5; i++){
-        std::string path = "assets/backgrounds and textures/gamewin/winbg" + std::to_string(i+1) + ".png";
-        SDL_Surface* surf = IMG_Load(path.c_str());
-        if (!surf){
-            std::cerr << "Failed to load " << path << ": " << IMG_GetError() << "\n";
-            continue;
-        }
-        gamewinTextures[i+1] = SDL_CreateTextureFromSurface(renderer, surf);
-        SDL_FreeSurface(surf);
+        gameoverTextures[i+1] = textureHandle("assets/backgrounds and textures/gameover/gameoverbg" + std::to_string(i+1) + ".png",
+                                           TEXTURE_END_SCREEN);
+        gamewinTextures[i+1] = textureHandle("assets/backgrounds and textures/gamewin/winbg" + std::to_string(i+1) + ".png",
+                                          TEXTURE_END_SCREEN);
     }
     return true;
 }
 
 void freeAllTextures()
 {
-    if (startBackground)    { SDL_DestroyTexture(startBackground);    startBackground = nullptr; }
-    if (gridBackground)     { SDL_DestroyTexture(gridBackground);     gridBackground = nullptr; }
-    if (sidebarBackground)  { SDL_DestroyTexture(sidebarBackground);  sidebarBackground = nullptr;}
-    if (scoreBackground)    { SDL_DestroyTexture(scoreBackground);    scoreBackground = nullptr;}
-    if (recordBackground)   { SDL_DestroyTexture(recordBackground);   recordBackground = nullptr;}
-    if (optionBackground)   { SDL_DestroyTexture(optionBackground);   optionBackground = nullptr; }
-    if (gameoverBackground) { SDL_DestroyTexture(gameoverBackground); gameoverBackground = nullptr;}
-    if (gamewonBackground)  { SDL_DestroyTexture(gamewonBackground);  gamewonBackground = nullptr;}
-    if (blockerTexture)     { SDL_DestroyTexture(blockerTexture);     blockerTexture = nullptr;}
-    if (cloudTexture)       { SDL_DestroyTexture(cloudTexture);       cloudTexture = nullptr; }
-    if (musicbarTexture)    { SDL_DestroyTexture(musicbarTexture);    musicbarTexture = nullptr; }
-    if (musictoggleTexture) { SDL_DestroyTexture(musictoggleTexture); musictoggleTexture = nullptr; }
-
-    for (auto& kv : fruitTextures) {
-        if (kv.second) {
-            SDL_DestroyTexture(kv.second);
-        }
-    }
+    // Several globals can point at the same cached texture, so clear them all
+    // and destroy each texture once through the cache.
+    startBackground = nullptr;
+    gridBackground = nullptr;
+    sidebarBackground = nullptr;
+    scoreBackground = nullptr;
+    recordBackground = nullptr;
+    optionBackground = nullptr;
+    gameoverBackground = nullptr;
+    gamewonBackground = nullptr;
+    blockerTexture = nullptr;
+    cloudTexture = nullptr;
+    musicbarTexture = nullptr;
+    musictoggleTexture = nullptr;
     fruitTextures.clear();
-
-    for (auto& kv : gameoverTextures) {
-        if (kv.second){
-            SDL_DestroyTexture(kv.second);
-        }
-    }
     gameoverTextures.clear();
+    gamewinTextures.clear();
 
-    for (auto& kv : gamewinTextures) {
-        if (kv.second){
-            SDL_DestroyTexture(kv.second);
+    for (auto& kv : textureCache) {
+        if (kv.second.texture) {
+            SDL_DestroyTexture(kv.second.texture);
         }
     }
-    gamewinTextures.clear();
-}
-
-void cleanupTextures() {
-    SDL_DestroyTexture(gridBackground);
-    SDL_DestroyTexture(optionBackground);
-    SDL_DestroyTexture(startBackground);
-    SDL_DestroyTexture(sidebarBackground);
-    SDL_DestroyTexture(recordBackground);
-    SDL_DestroyTexture(gameoverBackground);
-    SDL_DestroyTexture(scoreBackground);
-    SDL_DestroyTexture(blockerTexture);
-    SDL_DestroyTexture(cloudTexture);
-    SDL_DestroyTexture(musicbarTexture);
-    SDL_DestroyTexture(musictoggleTexture);
+    textureCache.clear();
+    for (size_t& bytes : categoryBytes) {
+        bytes = 0;
+    }
 }
@@ -2,9 +2,77 @@
 #define TEXTURES_H_INCLUDED
 
 #include <SDL.h>
+#include <functional>
 #include <string>
 #include <map>
+#include <vector>
 
+// What a texture is for, so memory use can be reported per kind.
+enum TextureCategory {
+    TEXTURE_BACKGROUND,
+    TEXTURE_FRUIT,
+    TEXTURE_END_SCREEN,   // Record, win and game over art.
+    TEXTURE_UI,           // Buttons, sliders and booster icons.
+    TEXTURE_TEXT,         // Pre-rendered help and credits pages.
+    TEXTURE_CATEGORY_COUNT
+};
+
+// Textures are kept under this many megabytes unless --texture-budget says
+// otherwise; sized for boards that share 256 MB between CPU and GPU.
+const int DEFAULT_TEXTURE_BUDGET_MB = 96;
+
+// A texture loaded through the asset loader on first use. There is one
+// handle per file path, so every user of the same image shares one texture.
+struct LazyTexture {
+    std::string path;
+    TextureCategory category = TEXTURE_BACKGROUND;
+    SDL_Texture* texture = nullptr;
+    size_t bytes = 0;
+    bool requested = false;
+    bool pinned = false;        // Copied into a global, so never evicted.
+    Uint32 lastUsed = 0;        // SDL_GetTicks() of the last useTexture().
+    std::vector<std::function<void(SDL_Texture*)>> onReady;
+};
+
+// Returns the shared handle for a path. Handles live until freeAllTextures().
+LazyTexture* textureHandle(const std::string& path, TextureCategory category);
+
+// Loads a texture that stays resident and hands it to assign() once it
+// arrives (at once if it already has).
+void loadPinnedTexture(const std::string& path, TextureCategory category,
+                       std::function<void(SDL_Texture*)> assign);
+
+// Returns the texture if resident; otherwise starts loading it and returns
+// nullptr so the caller can skip it for the few frames until it arrives.
+// Marks the texture as recently used.
+SDL_Texture* useTexture(LazyTexture* handle);
+
+// Starts loading a texture that is likely to be needed soon.
+void prefetchTexture(LazyTexture* handle);
+
+// Destroys a resident texture; the next useTexture() loads it again.
+// A load still in flight is left to finish.
+void releaseTexture(LazyTexture* handle);
+
+void setTextureBudget(size_t bytes);
+size_t textureBudget();
+
+// Bytes resident in one category, or in all of them.
+size_t textureBytes(TextureCategory category);
+size_t totalTextureBytes();
+const char* textureCategoryName(TextureCategory category);
+
+// Estimated memory of a texture from its size and pixel format.
+size_t textureSizeBytes(SDL_Texture* texture);
+
+// Accounts for a texture created outside this module (e.g. render targets).
+// Growth may evict least recently used textures to stay under budget.
+void trackTextureBytes(TextureCategory category, size_t bytes);
+void untrackTextureBytes(TextureCategory category, size_t bytes);
+
+// Queues the textures every session needs on the asset loader. Globals are
+// filled in as pumpAssetLoader() delivers them, so draw code must tolerate
+// nullptr. Rarely shown screens are left to load lazily.
 bool loadAllTextures(SDL_Renderer* renderer);
 void freeAllTextures();
 
@@ -0,0 +1,67 @@
+#include "tilebatch.h"
+#include "softrender.h"
+#include <vector>
+
+struct TileBatch {
+    SDL_Texture* texture;
+    std::vector<SDL_Rect> tiles;
+};
+
+// Kept between frames so their storage is reused; a board has only a
+// handful of distinct tile textures.
+static std::vector<TileBatch> batches;
+static std::vector<SDL_Vertex> vertices;
+static std::vector<int> indices;
+
+void batchTile(SDL_Texture* texture, const SDL_Rect& dest)
+{
+    for (TileBatch& batch : batches) {
+        if (batch.texture == texture) {
+            batch.tiles.push_back(dest);
+            return;
+        }
+    }
+    TileBatch batch = { texture, std::vector<SDL_Rect>(1, dest) };
+    batches.push_back(batch);
+}
+
+static void appendQuad(const SDL_Rect& r)
+{
+    const SDL_Color white = { 255, 255, 255, 255 };
+    int base = (int)vertices.size();
+    float x0 = (float)r.x, y0 = (float)r.y, x1 = (float)(r.x + r.w), y1 = (float)(r.y + r.h);
+    vertices.push_back({ { x0, y0 }, white, { 0.0f, 0.0f } });
+    vertices.push_back({ { x1, y0 }, white, { 1.0f, 0.0f } });
+    vertices.push_back({ { x1, y1 }, white, { 1.0f, 1.0f } });
+    vertices.push_back({ { x0, y1 }, white, { 0.0f, 1.0f } });
+    const int corners[6] = { 0, 1, 2, 2, 3, 0 };
+    for (int c : corners) {
+        indices.push_back(base + c);
+    }
+}
+
+void flushTileBatch(SDL_Renderer* renderer)
+{
+    for (TileBatch& batch : batches) {
+        if (batch.tiles.empty())
+            continue;
+        // Software rendering keeps its pre-scaled copies: one plain blit per
+        // tile beats scaling every triangle on the CPU.
+        bool drawn = false;
+        if (!softwareRendering()) {
+            vertices.clear();
+            indices.clear();
+            for (const SDL_Rect& r : batch.tiles) {
+                appendQuad(r);
+            }
+            drawn = SDL_RenderGeometry(renderer, batch.texture, vertices.data(), (int)vertices.size(),
+                                       indices.data(), (int)indices.size()) == 0;
+        }
+        if (!drawn) {
+            for (const SDL_Rect& r : batch.tiles) {
+                drawScaled(renderer, batch.texture, r);
+            }
+        }
+        batch.tiles.clear();
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef TILEBATCH_H
+#define TILEBATCH_H
+
+#include <SDL.h>
+
+// Board tiles are queued as quads and drawn with one SDL_RenderGeometry call
+// per texture, so a 32x32 board costs about as many draw calls as a 4x4 one.
+// Tiles never overlap, so grouping them by texture leaves the picture as is.
+
+void batchTile(SDL_Texture* texture, const SDL_Rect& dest);
+
+// Draws everything queued since the last flush and empties the batch.
+void flushTileBatch(SDL_Renderer* renderer);
+
+#endif // TILEBATCH_H
@@ -0,0 +1,109 @@
+#include "timers.h"
+#include <queue>
+#include <vector>
+
+struct Deadline {
+    Uint32 due;
+    TimerId id;
+    Uint32 generation;
+
+    bool operator>(const Deadline& other) const { return due > other.due; }
+};
+
+struct TimerSlot {
+    bool armed;
+    Uint32 due;
+    Uint32 generation;
+    TimerCallback callback;
+};
+
+// Cancelled or re-armed entries stay in the heap and are skipped when their
+// generation no longer matches the slot's.
+static std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> heap;
+static TimerSlot slots[TIMER_COUNT];
+static bool paused = false;
+static Uint32 pausedAt = 0;
+static Uint32 pausedTotal = 0;
+
+static Uint32 gameClock()
+{
+    return (paused ? pausedAt : SDL_GetTicks()) - pausedTotal;
+}
+
+void scheduleTimer(TimerId id, Uint32 delayMs, TimerCallback callback)
+{
+    TimerSlot& slot = slots[id];
+    slot.armed = true;
+    slot.due = gameClock() + delayMs;
+    slot.generation++;
+    slot.callback = callback;
+    heap.push({ slot.due, id, slot.generation });
+}
+
+void cancelTimer(TimerId id)
+{
+    slots[id].armed = false;
+    slots[id].generation++;
+}
+
+Uint32 timerRemaining(TimerId id)
+{
+    const TimerSlot& slot = slots[id];
+    if (!slot.armed)
+        return 0;
+    Sint32 left = (Sint32)(slot.due - gameClock());
+    return left > 0 ? (Uint32)left : 0;
+}
+
+void pauseTimers()
+{
+    if (paused)
+        return;
+    paused = true;
+    pausedAt = SDL_GetTicks();
+}
+
+void resumeTimers()
+{
+    if (!paused)
+        return;
+    paused = false;
+    pausedTotal += SDL_GetTicks() - pausedAt;
+}
+
+static bool isStale(const Deadline& d)
+{
+    return !slots[d.id].armed || slots[d.id].generation != d.generation;
+}
+
+void runDueTimers()
+{
+    Uint32 now = gameClock();
+    while (!heap.empty()) {
+        Deadline next = heap.top();
+        if (isStale(next)) {
+            heap.pop();
+            continue;
+        }
+        if ((Sint32)(next.due - now) > 0)
+            break;
+        heap.pop();
+        // Disarm first so the callback may re-arm its own timer.
+        TimerSlot& slot = slots[next.id];
+        slot.armed = false;
+        slot.callback();
+    }
+}
+
+Uint32 msUntilNextTimer()
+{
+    if (paused)
+        return NO_TIMER_DUE;
+    while (!heap.empty() && isStale(heap.top())) {
+        heap.pop();
+    }
+    if (heap.empty())
+        return NO_TIMER_DUE;
+    Sint32 left = (Sint32)(heap.top().due - gameClock());
+    return left > 0 ? (Uint32)left : 0;
+}
@@ -0,0 +1,39 @@
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include <SDL.h>
+
+// Deadline scheduler for timed game effects. Deadlines live on a game clock
+// that stops while the timers are paused, so menus freeze every countdown.
+// Callbacks run on the main thread from runDueTimers().
+
+enum TimerId {
+    TIMER_BOOSTER,          // Score multiplier runs out.
+    TIMER_FREEZE,           // Freeze booster runs out.
+    TIMER_HIGHSCORE_TOAST,  // "New Record!" panel goes away.
+    TIMER_COUNT
+};
+
+typedef void (*TimerCallback)();
+
+// Returned by msUntilNextTimer() when nothing is due.
+const Uint32 NO_TIMER_DUE = 0xFFFFFFFF;
+
+// (Re)arms a timer; an earlier deadline for the same id is dropped.
+void scheduleTimer(TimerId id, Uint32 delayMs, TimerCallback callback);
+
+void cancelTimer(TimerId id);
+
+// Game-clock ms left before the timer fires; 0 if it is not armed.
+Uint32 timerRemaining(TimerId id);
+
+void pauseTimers();
+void resumeTimers();
+
+// Fires every callback whose deadline has passed, earliest first.
+void runDueTimers();
+
+// Real ms until the next deadline, or NO_TIMER_DUE if none (or paused).
+Uint32 msUntilNextTimer();
+
+#endif // TIMERS_H
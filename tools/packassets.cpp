@@ -0,0 +1,217 @@
+// packassets: converts everything under assets/ into a single pre-decoded
+// pack (see pack.h) that the game memory-maps at startup.
+//
+//   packassets [assets dir] [output pack] [--abgr]
+//
+// Images are decoded and converted to ARGB8888 (or ABGR8888 with --abgr,
+// for renderers that prefer it). Sound effects are decoded through
+// SDL_mixer opened at the game's output format, so the game can play them
+// without conversion. Music and fonts are stored as-is.
+#include "../audio.h"
+#include "../pack.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct PendingEntry {
+    PackEntry entry;
+    std::string path;
+    std::vector<Uint8> data;
+};
+
+static std::string lowerExtension(const fs::path& p)
+{
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+static bool readFile(const fs::path& p, std::vector<Uint8>& out)
+{
+    FILE* f = std::fopen(p.string().c_str(), "rb");
+    if (!f)
+        return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    out.resize(size > 0 ? (size_t)size : 0);
+    bool ok = out.empty() || std::fread(out.data(), 1, out.size(), f) == out.size();
+    std::fclose(f);
+    return ok;
+}
+
+static bool packImage(const fs::path& file, Uint32 pixelFormat, PendingEntry& pending)
+{
+    SDL_Surface* loaded = IMG_Load(file.string().c_str());
+    if (!loaded) {
+        std::cerr << "  skipped: " << IMG_GetError() << "\n";
+        return false;
+    }
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, pixelFormat, 0);
+    SDL_FreeSurface(loaded);
+    if (!converted) {
+        std::cerr << "  skipped: " << SDL_GetError() << "\n";
+        return false;
+    }
+    int rowBytes = converted->w * SDL_BYTESPERPIXEL(pixelFormat);
+    pending.entry.kind = PACK_IMAGE;
+    pending.entry.format = pixelFormat;
+    pending.entry.width = converted->w;
+    pending.entry.height = converted->h;
+    pending.entry.pitch = rowBytes;
+    pending.data.resize((size_t)rowBytes * converted->h);
+    SDL_LockSurface(converted);
+    for (int y = 0; y < converted->h; y++) {
+        std::memcpy(&pending.data[(size_t)y * rowBytes],
+                    (const Uint8*)converted->pixels + (size_t)y * converted->pitch, rowBytes);
+    }
+    SDL_UnlockSurface(converted);
+    SDL_FreeSurface(converted);
+    return true;
+}
+
+static bool packSound(const fs::path& file, PendingEntry& pending)
+{
+    Mix_Chunk* chunk = Mix_LoadWAV(file.string().c_str());
+    if (!chunk) {
+        std::cerr << "  skipped: " << Mix_GetError() << "\n";
+        return false;
+    }
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    pending.entry.kind = PACK_AUDIO;
+    pending.entry.format = format;
+    pending.entry.width = frequency;
+    pending.entry.height = channels;
+    pending.data.assign(chunk->abuf, chunk->abuf + chunk->alen);
+    Mix_FreeChunk(chunk);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string assetsDir = "assets";
+    std::string outputPath = "assets/assets.pak";
+    Uint32 pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--abgr") == 0) {
+            pixelFormat = SDL_PIXELFORMAT_ABGR8888;
+        } else if (positional == 0) {
+            assetsDir = argv[i];
+            positional++;
+        } else {
+            outputPath = argv[i];
+            positional++;
+        }
+    }
+
+    // No sound card is needed to convert audio; the dummy driver gives us
+    // exactly the format we ask for.
+    SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_AUDIO) != 0) {
+        std::cerr << "SDL init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+    if (Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, 2048) < 0) {
+        std::cerr << "SDL_mixer could not initialize! " << Mix_GetError() << "\n";
+        return 1;
+    }
+
+    std::vector<PendingEntry> pending;
+    for (const auto& item : fs::recursive_directory_iterator(assetsDir)) {
+        if (!item.is_regular_file())
+            continue;
+        // Keys are the paths the game asks for, e.g. "assets/Fruit/apple.jpg".
+        std::string key = "assets/" + fs::relative(item.path(), assetsDir).generic_string();
+        std::string ext = lowerExtension(item.path());
+
+        PendingEntry entry = {};
+        entry.path = key;
+        bool ok = false;
+        if (ext == ".png" || ext == ".jpg" || ext == ".jpeg") {
+            ok = packImage(item.path(), pixelFormat, entry);
+        } else if (ext == ".wav") {
+            ok = packSound(item.path(), entry);
+        } else if (ext == ".mp3" || ext == ".ogg" || ext == ".ttf") {
+            entry.entry.kind = PACK_RAW;
+            ok = readFile(item.path(), entry.data);
+        } else {
+            continue;   // Text files and the pack itself stay loose.
+        }
+        if (!ok)
+            continue;
+        entry.entry.id = assetId(key.c_str());
+        entry.entry.size = entry.data.size();
+        std::cout << key << " (" << entry.data.size() << " bytes)\n";
+        pending.push_back(std::move(entry));
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const PendingEntry& a, const PendingEntry& b) {
+        return a.entry.id < b.entry.id;
+    });
+    for (size_t i = 1; i < pending.size(); i++) {
+        if (pending[i].entry.id == pending[i - 1].entry.id) {
+            std::cerr << "Hash collision between " << pending[i - 1].path << " and " << pending[i].path << "\n";
+            return 1;
+        }
+    }
+
+    Uint64 offset = sizeof(PackHeader) + pending.size() * sizeof(PackEntry);
+    for (auto& p : pending) {
+        offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        p.entry.offset = offset;
+        offset += p.entry.size;
+    }
+
+    std::string tempPath = outputPath + ".tmp";
+    FILE* out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Cannot write " << tempPath << "\n";
+        return 1;
+    }
+    PackHeader header = {};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.entryCount = (Uint32)pending.size();
+    std::fwrite(&header, sizeof(header), 1, out);
+    for (const auto& p : pending) {
+        std::fwrite(&p.entry, sizeof(PackEntry), 1, out);
+    }
+    Uint64 written = sizeof(PackHeader) + pending.size() * sizeof(PackEntry);
+    static const Uint8 zeros[PACK_ALIGNMENT] = {};
+    for (const auto& p : pending) {
+        std::fwrite(zeros, 1, (size_t)(p.entry.offset - written), out);
+        if (!p.data.empty())
+            std::fwrite(p.data.data(), 1, p.data.size(), out);
+        written = p.entry.offset + p.entry.size;
+    }
+    bool ok = std::ferror(out) == 0;
+    ok = (std::fclose(out) == 0) && ok;
+    if (ok) {
+        std::error_code ec;
+        fs::rename(tempPath, outputPath, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        std::cerr << "Failed to write " << outputPath << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << pending.size() << " assets (" << written << " bytes) to " << outputPath << "\n";
+
+    Mix_CloseAudio();
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "ui.h"
+#include "globals.h"
+#include "graphics.h"
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <vector>
+
+// A horizontal strip of the screen in which the set of overlapping widgets
+// does not change. Hit-testing binary searches the strip by y, then the
+// strip's widgets (sorted by x) by x.
+struct UiBand {
+    int top;                    // Inclusive.
+    int bottom;                 // Exclusive.
+    std::vector<int> widgets;   // Indices into UiTree::widgets, sorted by hitRect.x.
+};
+
+struct UiTree {
+    std::vector<UiWidget> widgets;
+    std::vector<UiBand> bands;
+};
+
+static UiTree trees[UI_SCREEN_COUNT];
+
+static void addWidget(UiScreen screen, UiWidgetId id, UiWidgetKind kind, const char* label,
+                      SDL_Rect rect, int hitMargin = 0)
+{
+    SDL_Rect hit = { rect.x - hitMargin, rect.y - hitMargin, rect.w + 2 * hitMargin, rect.h + 2 * hitMargin };
+    trees[screen].widgets.push_back({ id, kind, label, rect, hit });
+}
+
+static void buildBands(UiTree& tree)
+{
+    tree.bands.clear();
+    std::vector<int> edges;
+    for (const auto &w : tree.widgets) {
+        edges.push_back(w.hitRect.y);
+        edges.push_back(w.hitRect.y + w.hitRect.h + 1);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    for (size_t e = 0; e + 1 < edges.size(); e++) {
+        UiBand band = { edges[e], edges[e + 1], {} };
+        for (int i = 0; i < (int)tree.widgets.size(); i++) {
+            const SDL_Rect &r = tree.widgets[i].hitRect;
+            if (r.y <= band.top && r.y + r.h + 1 >= band.bottom)
+                band.widgets.push_back(i);
+        }
+        std::sort(band.widgets.begin(), band.widgets.end(), [&](int a, int b) {
+            return tree.widgets[a].hitRect.x < tree.widgets[b].hitRect.x;
+        });
+        tree.bands.push_back(band);
+    }
+}
+
+void layoutUi()
+{
+    for (auto &tree : trees) {
+        tree.widgets.clear();
+    }
+
+    // Game sidebar: booster icons and the options button.
+    const int iconSize = 50, iconSpacing = 20;
+    int iconX = GAME_AREA_WIDTH + SIDEBAR_WIDTH / 4;
+    int iconY = WINDOW_HEIGHT - 6 * iconSpacing;
+    addWidget(UI_SCREEN_GAME, WIDGET_HAMMER, WIDGET_KIND_ICON, nullptr,
+              { iconX, iconY, iconSize, iconSize });
+    addWidget(UI_SCREEN_GAME, WIDGET_FREEZE, WIDGET_KIND_ICON, nullptr,
+              { iconX + iconSize + iconSpacing, iconY, iconSize, iconSize });
+    addWidget(UI_SCREEN_GAME, WIDGET_TSUNAMI, WIDGET_KIND_ICON, nullptr,
+              { iconX + 2 * (iconSize + iconSpacing), iconY, iconSize, iconSize });
+    addWidget(UI_SCREEN_GAME, WIDGET_OPTIONS_BUTTON, WIDGET_KIND_BUTTON, "Options",
+              { GAME_AREA_WIDTH + 10, WINDOW_HEIGHT - 60, SIDEBAR_WIDTH - 20, 50 });
+
+    // Options menu.
+    const int optBtnWidth = 220, optBtnHeight = 70, optSpacing = 20, optStartY = 120;
+    int optX = (WINDOW_WIDTH - optBtnWidth) / 2;
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_HELP, WIDGET_KIND_BUTTON, "Help",
+              { optX, optStartY, optBtnWidth, optBtnHeight });
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_RESTART, WIDGET_KIND_BUTTON, "Restart",
+              { optX, optStartY + (optBtnHeight + optSpacing), optBtnWidth, optBtnHeight });
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_CREDITS, WIDGET_KIND_BUTTON, "Credits",
+              { optX, optStartY + 2 * (optBtnHeight + optSpacing), optBtnWidth, optBtnHeight });
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_QUIT, WIDGET_KIND_BUTTON, "Quit",
+              { optX, optStartY + 3 * (optBtnHeight + optSpacing), optBtnWidth, optBtnHeight });
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_BACK, WIDGET_KIND_BUTTON, "Back",
+              { WINDOW_WIDTH - optBtnWidth - 20, WINDOW_HEIGHT - optBtnHeight - 20, optBtnWidth, optBtnHeight });
+
+    const int sliderWidth = 300, sliderHeight = 20;
+    int sliderX = (WINDOW_WIDTH - sliderWidth) / 2;
+    int musicSliderY = optStartY + 4 * (optBtnHeight + optSpacing) + 30;
+    int sfxSliderY = musicSliderY + 60;
+    // The toggle knob overhangs the bar by 5px, so that much is clickable too.
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_MUSIC_SLIDER, WIDGET_KIND_SLIDER, "Music",
+              { sliderX, musicSliderY, sliderWidth, sliderHeight });
+    addWidget(UI_SCREEN_OPTIONS, WIDGET_SFX_SLIDER, WIDGET_KIND_SLIDER, "SFX",
+              { sliderX, sfxSliderY, sliderWidth, sliderHeight });
+    for (auto &w : trees[UI_SCREEN_OPTIONS].widgets) {
+        if (w.kind == WIDGET_KIND_SLIDER) {
+            w.hitRect.y -= 5;
+            w.hitRect.h += 10;
+        }
+    }
+
+    // Help and credits share the bottom-right cloud button.
+    SDL_Rect cornerBtn = { WINDOW_WIDTH - DEFAULT_CLOUD_BTN_WIDTH - 20, WINDOW_HEIGHT - DEFAULT_CLOUD_BTN_HEIGHT - 20,
+                           DEFAULT_CLOUD_BTN_WIDTH, DEFAULT_CLOUD_BTN_HEIGHT };
+    addWidget(UI_SCREEN_HELP, WIDGET_CLOSE, WIDGET_KIND_BUTTON, "Close", cornerBtn);
+    addWidget(UI_SCREEN_CREDITS, WIDGET_BACK, WIDGET_KIND_BUTTON, "Back", cornerBtn);
+
+    // Game over and win buttons sit below a title and a line of text, which are
+    // rendered at the fonts' full height.
+    int titleH = titleFont ? TTF_FontHeight(titleFont) : 0;
+    int smallH = smallFont ? TTF_FontHeight(smallFont) : 0;
+    int textBottom = (WINDOW_HEIGHT / 4) - (titleH / 2) + titleH + 10 + smallH;
+
+    const int overBtnWidth = 200, overBtnHeight = 60, overSpacing = 20;
+    int overStartY = textBottom + 30;
+    addWidget(UI_SCREEN_GAMEOVER, WIDGET_RESTART, WIDGET_KIND_BUTTON, "Restart",
+              { (WINDOW_WIDTH - overBtnWidth) / 2, overStartY, overBtnWidth, overBtnHeight });
+    addWidget(UI_SCREEN_GAMEOVER, WIDGET_QUIT, WIDGET_KIND_BUTTON, "Quit",
+              { (WINDOW_WIDTH - overBtnWidth) / 2, overStartY + overBtnHeight + overSpacing, overBtnWidth, overBtnHeight });
+
+    const int winBtnWidth = 250, winBtnHeight = 70, winSpacing = 20, winMargin = 10;
+    int winStartY = textBottom + 30;
+    addWidget(UI_SCREEN_WIN, WIDGET_CONTINUE, WIDGET_KIND_BUTTON, "Continue",
+              { (WINDOW_WIDTH - winBtnWidth) / 2, winStartY, winBtnWidth, winBtnHeight }, winMargin);
+    addWidget(UI_SCREEN_WIN, WIDGET_QUIT, WIDGET_KIND_BUTTON, "Quit",
+              { (WINDOW_WIDTH - winBtnWidth) / 2, winStartY + winBtnHeight + winSpacing, winBtnWidth, winBtnHeight }, winMargin);
+
+    for (auto &tree : trees) {
+        buildBands(tree);
+    }
+}
+
+UiWidgetId uiHitTest(UiScreen screen, int x, int y)
+{
+    const UiTree &tree = trees[screen];
+    auto band = std::upper_bound(tree.bands.begin(), tree.bands.end(), y,
+                                 [](int value, const UiBand &b) { return value < b.top; });
+    if (band == tree.bands.begin())
+        return WIDGET_NONE;
+    --band;
+    if (y >= band->bottom)
+        return WIDGET_NONE;
+
+    auto it = std::upper_bound(band->widgets.begin(), band->widgets.end(), x,
+                               [&](int value, int i) { return value < tree.widgets[i].hitRect.x; });
+    while (it != band->widgets.begin()) {
+        --it;
+        const SDL_Rect &r = tree.widgets[*it].hitRect;
+        if (x <= r.x + r.w)
+            return tree.widgets[*it].id;
+    }
+    return WIDGET_NONE;
+}
+
+const UiWidget* uiWidget(UiScreen screen, UiWidgetId id)
+{
+    for (const auto &w : trees[screen].widgets) {
+        if (w.id == id)
+            return &w;
+    }
+    return nullptr;
+}
+
+SDL_Rect uiRect(UiScreen screen, UiWidgetId id)
+{
+    const UiWidget* w = uiWidget(screen, id);
+    return w ? w->rect : SDL_Rect{ 0, 0, 0, 0 };
+}
+
+int uiSliderValue(const UiWidget& slider, int x, int maxValue)
+{
+    int clampedX = std::max(slider.rect.x, std::min(x, slider.rect.x + slider.rect.w));
+    return ((clampedX - slider.rect.x) * maxValue) / slider.rect.w;
+}
+
+void drawUiButtons(SDL_Renderer* renderer, UiScreen screen, TTF_Font* font)
+{
+    for (const auto &w : trees[screen].widgets) {
+        if (w.kind == WIDGET_KIND_BUTTON)
+            drawCloudButtonWithText(renderer, cloudTexture, w.rect, w.label, font);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef UI_H
+#define UI_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+// Screens that own a widget tree.
+enum UiScreen {
+    UI_SCREEN_START,
+    UI_SCREEN_GAME,
+    UI_SCREEN_OPTIONS,
+    UI_SCREEN_HELP,
+    UI_SCREEN_CREDITS,
+    UI_SCREEN_GAMEOVER,
+    UI_SCREEN_WIN,
+    UI_SCREEN_MARATHON,
+    UI_SCREEN_COUNT
+};
+
+enum UiWidgetId {
+    WIDGET_NONE,
+    WIDGET_OPTIONS_BUTTON,
+    WIDGET_HAMMER,
+    WIDGET_FREEZE,
+    WIDGET_TSUNAMI,
+    WIDGET_HELP,
+    WIDGET_RESTART,
+    WIDGET_CREDITS,
+    WIDGET_QUIT,
+    WIDGET_BACK,
+    WIDGET_CLOSE,
+    WIDGET_CONTINUE,
+    WIDGET_MUSIC_SLIDER,
+    WIDGET_SFX_SLIDER
+};
+
+enum UiWidgetKind {
+    WIDGET_KIND_BUTTON,   // Cloud button with a text label.
+    WIDGET_KIND_ICON,     // Booster icon, drawn by its owner.
+    WIDGET_KIND_SLIDER    // Volume bar, drawn by its owner.
+};
+
+struct UiWidget {
+    UiWidgetId id;
+    UiWidgetKind kind;
+    const char* label;
+    SDL_Rect rect;      // Where the widget is drawn.
+    SDL_Rect hitRect;   // Clickable area, edges inclusive.
+};
+
+// Size of the toggle knob drawn on top of the volume sliders.
+const int UI_SLIDER_TOGGLE_SIZE = 30;
+
+// Rebuilds every screen's widget tree. Call once per resize, after fonts load.
+void layoutUi();
+
+// Returns the widget under (x, y) on the given screen, or WIDGET_NONE.
+UiWidgetId uiHitTest(UiScreen screen, int x, int y);
+
+// Returns the laid out widget, or nullptr if the screen does not have it.
+const UiWidget* uiWidget(UiScreen screen, UiWidgetId id);
+
+// Convenience accessor; returns an empty rect for unknown widgets.
+SDL_Rect uiRect(UiScreen screen, UiWidgetId id);
+
+// Maps an x coordinate on a slider widget to a 0..maxValue volume.
+int uiSliderValue(const UiWidget& slider, int x, int maxValue);
+
+// Draws every labelled button of a screen with the given font.
+void drawUiButtons(SDL_Renderer* renderer, UiScreen screen, TTF_Font* font);
+
+#endif // UI_H
@@ -0,0 +1,84 @@
+#include "video.h"
+#include "log.h"
+
+int downscaledSize(int size, int downscale)
+{
+    return SDL_max(1, size / SDL_max(1, downscale));
+}
+
+size_t y4mFrameBytes(int width, int height)
+{
+    return (size_t)width * height * 3;
+}
+
+static Uint8 clampByte(int v)
+{
+    return (Uint8)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+void convertFrame(const Uint8* argb, int pitch, int width, int height, int downscale, Uint8* planes)
+{
+    downscale = SDL_max(1, downscale);
+    int outW = downscaledSize(width, downscale);
+    int outH = downscaledSize(height, downscale);
+    size_t planeSize = (size_t)outW * outH;
+    Uint8* yPlane = planes;
+    Uint8* uPlane = planes + planeSize;
+    Uint8* vPlane = planes + 2 * planeSize;
+    int samples = downscale * downscale;
+
+    for (int y = 0; y < outH; y++) {
+        for (int x = 0; x < outW; x++) {
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < downscale; dy++) {
+                const Uint32* row = (const Uint32*)(argb + (size_t)(y * downscale + dy) * pitch) + x * downscale;
+                for (int dx = 0; dx < downscale; dx++) {
+                    Uint32 p = row[dx];
+                    r += (p >> 16) & 0xFF;
+                    g += (p >> 8) & 0xFF;
+                    b += p & 0xFF;
+                }
+            }
+            r /= samples;
+            g /= samples;
+            b /= samples;
+            // Full-range BT.601 in 8.8 fixed point.
+            size_t i = (size_t)y * outW + x;
+            yPlane[i] = clampByte((77 * r + 150 * g + 29 * b + 128) >> 8);
+            uPlane[i] = clampByte((-43 * r - 85 * g + 128 * b + 32768 + 128) >> 8);
+            vPlane[i] = clampByte((128 * r - 107 * g - 21 * b + 32768 + 128) >> 8);
+        }
+    }
+}
+
+bool openY4m(Y4mFile& video, const char* path, int width, int height, int fps)
+{
+    video = Y4mFile();
+    video.file = std::fopen(path, "wb");
+    if (!video.file) {
+        LOG_ERROR(LOG_RENDER, "Cannot create video file %s", path);
+        return false;
+    }
+    video.width = width;
+    video.height = height;
+    std::fprintf(video.file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444 XCOLORRANGE=FULL\n", width, height, fps);
+    return true;
+}
+
+bool writeY4mFrame(Y4mFile& video, const Uint8* planes)
+{
+    if (!video.file)
+        return false;
+    size_t bytes = y4mFrameBytes(video.width, video.height);
+    if (std::fputs("FRAME\n", video.file) < 0 || std::fwrite(planes, 1, bytes, video.file) != bytes)
+        return false;
+    video.frames++;
+    return true;
+}
+
+void closeY4m(Y4mFile& video)
+{
+    if (video.file)
+        std::fclose(video.file);
+    video.file = nullptr;
+}
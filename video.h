@@ -0,0 +1,35 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include <SDL.h>
+#include <cstddef>
+#include <cstdio>
+
+// Uncompressed YUV4MPEG2 (.y4m) video: a text header, then for each frame
+// the Y, U and V planes at full resolution (4:4:4, full-range BT.601).
+// There is no compression to wait on and no chroma subsampling; players and
+// ffmpeg read it as is.
+
+struct Y4mFile {
+    FILE* file = nullptr;
+    int width = 0;
+    int height = 0;
+    Uint32 frames = 0;
+};
+
+// Size of a frame side after shrinking by downscale (1 keeps it).
+int downscaledSize(int size, int downscale);
+
+// Bytes of one frame's planes.
+size_t y4mFrameBytes(int width, int height);
+
+// Converts an ARGB8888 frame of width x height into the planes of a frame
+// downscale times smaller, averaging each downscale x downscale block.
+// Touches nothing shared, so frames may be converted on several threads.
+void convertFrame(const Uint8* argb, int pitch, int width, int height, int downscale, Uint8* planes);
+
+bool openY4m(Y4mFile& video, const char* path, int width, int height, int fps);
+bool writeY4mFrame(Y4mFile& video, const Uint8* planes);
+void closeY4m(Y4mFile& video);
+
+#endif // VIDEO_H